@@ -1,6 +1,10 @@
 #include "Arduino.h"
 #include "MonorailSystem.h"
+#include "SeaRobArena.h"
 #include "SeaRobDisplay.h"
+#include "SeaRobOutput.h"
+#include "SeaRobProfiler.h"
+#include "SeaRobScheduler.h"
 #include "SeaRobSpringButtonLight.h"
 #include "SeaRobLogger.h"
 
@@ -54,9 +58,15 @@ const char      buildTimestamp[] =  __DATE__ " " __TIME__;
 const char      buildDatestamp[] = __DATE__;
 
 
-// Global Variables: the OLED Display, connected via I2C interface
+// Global Variables: the OLED Display, connected via I2C interface (hardware TWI pins)
 boolean useDisplay = true; 
-SeaRobDisplay display(PIN_I2C_SDA, PIN_I2C_SCL);
+SeaRobDisplay display(PIN_I2C_SDA, PIN_I2C_SCL, SeaRobDisplay::Transport::HardwareTwi);
+
+
+// Global Variables: Loop profiler; send 'p' over the Serial Monitor for a dump, 'r' to reset.
+int profileLoop = -1;
+int profileObjects = -1;
+int profileDisplay = -1;
 
 
 // Global Variables: multi-slab
@@ -102,7 +112,7 @@ void onButtonDown_StreetLights(SeaRobSpringButtonLight *buttonLight, long update
 }
 
 void onButtonDown_Slab5_FELight(SeaRobSpringButtonLight *buttonLight, long updateTime) {
-  bclogger("onButtonDown_Slab5_FELight: %s", buttonLight->GetName());
+  bclogger("onButtonDown_Slab5_FELight: %S", buttonLight->GetName());
 }
 
 void onButtonDown_Slab6_CaveLight(SeaRobSpringButtonLight *buttonLight, long updateTime) {
@@ -123,7 +133,7 @@ void setup() {
   startTime = millis();
   
   // Init the serial line; important for debug messages back to the Arduino Serial Monitor..
-  Serial.begin(9600);
+  bclogger_setup();
   bclogger(""); // Skip line to seperate from last instance of the program.
   bclogger("setup: begin \"%s\" (build: %s)", buildName.c_str(), buildTimestamp);
 
@@ -131,11 +141,13 @@ void setup() {
   if (useDisplay) {
     bclogger("setup: OLED start...");
     display.setup(buildTimestamp);
+    display.setupStandardLayout();
+    display.setField(SeaRobDisplay::Header, "cascadia slabtown 1.0");
     bclogger("setup: OLED complete");
   }
 
   // Global streetlight button: various slabs will later add their pins to it.
-  streetLights = new SeaRobSpringButtonLight("streetlights", 
+  streetLights = new SeaRobSpringButtonLight(F("streetlights"), 
         PIN_STREET_LIGHTS_BUTTON, -1, false, false, //non-dimmable, no internal pullup
         onButtonDown_StreetLights, NULL, NULL);
 
@@ -144,22 +156,22 @@ void setup() {
     bclogger("setup: slab-5 start...");
 
     // Init the front-end passthrus in slab 5.
-    feA1Light = new SeaRobSpringButtonLight("feA1", 
+    feA1Light = new SeaRobSpringButtonLight(F("feA1"), 
         PIN_SLAB5_FE_A1_BUTTON, PIN_SLAB5_FE_A1_CTRL, false, false, //non-dimmable, no internal pullup
         onButtonDown_Slab5_FELight, NULL, NULL);
-    feA2Light = new SeaRobSpringButtonLight("feA2", 
+    feA2Light = new SeaRobSpringButtonLight(F("feA2"), 
         PIN_SLAB5_FE_A2_BUTTON, PIN_SLAB5_FE_A2_CTRL, false, false, //non-dimmable, no internal pullup
         onButtonDown_Slab5_FELight, NULL, NULL);
-    feA3Light = new SeaRobSpringButtonLight("feA3", 
+    feA3Light = new SeaRobSpringButtonLight(F("feA3"), 
         PIN_SLAB5_FE_A3_BUTTON, PIN_SLAB5_FE_A3_CTRL, false, false, //non-dimmable, no internal pullup
         onButtonDown_Slab5_FELight, NULL, NULL);
-    feB1Light = new SeaRobSpringButtonLight("feA1", 
+    feB1Light = new SeaRobSpringButtonLight(F("feA1"), 
         PIN_SLAB5_FE_B1_BUTTON, PIN_SLAB5_FE_B1_CTRL, false, false, //non-dimmable, no internal pullup
         onButtonDown_Slab5_FELight, NULL, NULL);
-    feB2Light = new SeaRobSpringButtonLight("feA2", 
+    feB2Light = new SeaRobSpringButtonLight(F("feA2"), 
         PIN_SLAB5_FE_B2_BUTTON, PIN_SLAB5_FE_B2_CTRL, false, false, //non-dimmable, no internal pullup
         onButtonDown_Slab5_FELight, NULL, NULL);
-    feB3Light = new SeaRobSpringButtonLight("feA3", 
+    feB3Light = new SeaRobSpringButtonLight(F("feA3"), 
         PIN_SLAB5_FE_B3_BUTTON, PIN_SLAB5_FE_B3_CTRL, false, false, //non-dimmable, no internal pullup
         onButtonDown_Slab5_FELight, NULL, NULL);
 
@@ -176,18 +188,19 @@ void setup() {
     bclogger("setup: slab-6 start...");
 
     // Cave Light - simple on/off light for the cave, no complex logic. Defaults to on at startup.
-    caveLight = new SeaRobSpringButtonLight("slab6-cavelight", 
+    caveLight = new SeaRobSpringButtonLight(F("slab6-cavelight"), 
         PIN_SLAB6_CAVE_LIGHT_BUTTON, PIN_SLAB6_CAVE_LIGHT_CTRL, false, false, //non-dimmable, no internal pullup
         onButtonDown_Slab6_CaveLight, NULL, NULL); 
     caveLight->GetLight()->ToggleOnOff();
 
     // Train Bridge Light - cool 5v fader light in train bridge, set in continous loop. 
     // Turning on/off will just restart the cycle. Defaults to looping on/off at startup.
-    trainBridgeRedBeamLight = new SeaRobSpringButtonLight("slab6-trainbidge-redbeam", 
+    trainBridgeRedBeamLight = new SeaRobSpringButtonLight(F("slab6-trainbidge-redbeam"), 
         PIN_SLAB6_TRAINBRIDGE_REDBEAM_BUTTON, PIN_SLAB6_TRAINBRIDGE_REDBEAM_CTRL, true, false, // dimmable, needs pwm pin
         onButtonDown_Slab6_TrainBridge_RedBeamLight, NULL, NULL);
     trainBridgeRedBeamLight->GetLight()->UpdateBlinkConfig(0, 0, TRAINBRIDGE_REDBEAM_DURATION_ON, TRAINBRIDGE_REDBEAM_DURATION_OFF, 
         false, TRAINBRIDGE_REDBEAM_DURATION_FADE, TRAINBRIDGE_REDBEAM_DURATION_FADE);
+    trainBridgeRedBeamLight->GetLight()->SetFadeCurve(SeaRobFade::Gamma);
     trainBridgeRedBeamLight->GetLight()->UpdateState(SeaRobLight::LightState::UniformBlink);
 
     // Wire up the slab6 section of the streelights to the global streetlight button.
@@ -200,11 +213,17 @@ void setup() {
 
   /*if (useSlab1) {
     monorail_system_setup(&monorail, MONORAIL_POLE_PIN_START_SLAB1);
-    monorailButton = new SeaRobSpringButton("monorail light control", PIN_MONORAIL_BUTTON, &onMonorailButtonDown);
+    monorailButton = new SeaRobSpringButton(F("monorail light control"), PIN_MONORAIL_BUTTON, &onMonorailButtonDown);
     bclogger("setup: slab-1 complete.");
   } */
   
+  profileLoop = SeaRobProfiler::AddSection(F("loop"));
+  profileObjects = SeaRobProfiler::AddSection(F("objects"));
+  profileDisplay = SeaRobProfiler::AddSection(F("display"));
+  
+  SeaRobArena::Freeze(); // the object graph is built; nothing allocates after this
   bclogger("setup: complete for \"%s\"", buildName.c_str());
+  bclogger_setAsync(true); // from here on the loop never waits on the Serial Monitor
 }
 
 
@@ -216,32 +235,18 @@ void loop() {
 
   // Get the current time.
   unsigned long now = lastUpdateTime = millis();
-
-  if (streetLights) {
-    streetLights->ProcessLoop(lastUpdateTime);
+  SeaRobProfileScope loopScope(profileLoop);
+  SeaRobProfiler::ProcessSerialCommand();
+  bclogger_drain();
+
+  // Every slab's buttons are polled, but lights only run when one of their blink or fade steps is due.
+  {
+    SeaRobProfileScope scope(profileObjects);
+    SeaRobScheduler::Service(lastUpdateTime);
   }
 
-  if (useSlab5) {
-    if (feA1Light) 
-      feA1Light->ProcessLoop(lastUpdateTime);
-    if (feA2Light) 
-      feA2Light->ProcessLoop(lastUpdateTime);
-    if (feA3Light) 
-      feA3Light->ProcessLoop(lastUpdateTime);
-    if (feB1Light) 
-      feB1Light->ProcessLoop(lastUpdateTime);
-    if (feB2Light) 
-      feB2Light->ProcessLoop(lastUpdateTime);
-    if (feB3Light) 
-      feB3Light->ProcessLoop(lastUpdateTime);
-  }
-  
-  if (useSlab6) {
-    if (caveLight)
-      caveLight->ProcessLoop(lastUpdateTime);
-    if (trainBridgeRedBeamLight)
-      trainBridgeRedBeamLight->ProcessLoop(lastUpdateTime);
-  }
+  // The lights only staged their pins; switch them all now, before the display gets its turn.
+  SeaRobOutput::Commit();
 
   /*if (useSlab1) {
       // Process input first so they have immediate impact.
@@ -252,52 +257,44 @@ void loop() {
   } */
 
   if (useDisplay) {
-      // Update the OLED screen with our current state.
-
-      #define LINE_BUFFER_SIZE 50
-      char headerBuffer[LINE_BUFFER_SIZE];
-      snprintf(headerBuffer, LINE_BUFFER_SIZE, "cascadia slabtown 1.0");
-      
+    SeaRobProfileScope scope(profileDisplay);
+    
+    // Update the OLED screen with our current state; fields are only re-formatted at the display's refresh rate.
+    if (display.isRefreshDue(lastUpdateTime)) {
       // Format the Uptime.
       unsigned long upSecs = (lastUpdateTime - startTime) / 1000;
-      char line1Buffer[LINE_BUFFER_SIZE];
-      snprintf(line1Buffer, LINE_BUFFER_SIZE, "%09lu %s", upSecs, buildDatestamp);
+      display.setFieldf(SeaRobDisplay::Line1, "%09lu %s", upSecs, buildDatestamp);
+
+      // Loop timing.
+      char profileBuffer[DISPLAY_FIELD_CHARS + 1];
+      SeaRobProfiler::GetOverlayString(profileLoop, profileBuffer, sizeof(profileBuffer));
+      display.setField(SeaRobDisplay::Line2, profileBuffer);
 
-       // TODO
-      char line2Buffer[LINE_BUFFER_SIZE];
-      snprintf(line2Buffer, 50, "");
-          
       // FrontEnd-Light monitoring
-      char line3Buffer[LINE_BUFFER_SIZE];
-      strcpy(line3Buffer, "fe ");
       if (useSlab5) {
-        int festrlen = strlen(line3Buffer);
-        snprintf(line3Buffer + festrlen, LINE_BUFFER_SIZE - festrlen, " [%c%c%c%c%c%c]", 
+        display.setFieldf(SeaRobDisplay::Line3, "fe  [%c%c%c%c%c%c]", 
           feA1Light && feA1Light->IsOn() ? '*' : 'o',
           feA2Light && feA2Light->IsOn() ? '*' : 'o',
           feA3Light && feA3Light->IsOn() ? '*' : 'o', 
           feB1Light && feB1Light->IsOn() ? '*' : 'o',
           feB2Light && feB2Light->IsOn() ? '*' : 'o',
           feB3Light && feB3Light->IsOn() ? '*' : 'o'); 
+      } else {
+        display.setField(SeaRobDisplay::Line3, "fe ");
       }
         
       // PF-Light monitoring
-      char line4Buffer[LINE_BUFFER_SIZE];
-      strcpy(line4Buffer, "l ");
       if (useSlab6) {
-        int litstrlen = strlen(line4Buffer);
-        snprintf(line4Buffer + litstrlen, LINE_BUFFER_SIZE - litstrlen, " [%c%c%c]", 
+        display.setFieldf(SeaRobDisplay::Line4, "l  [%c%c%c]", 
           caveLight && caveLight->IsOn() ? '*' : 'o',
           trainBridgeRedBeamLight && trainBridgeRedBeamLight->IsOn() ? '*' : 'o',
           streetLights && streetLights->IsOn() ? '*' : 'o');
+      } else {
+        display.setField(SeaRobDisplay::Line4, "l ");
       }
+    }
 
-      // Send to the display.
-      display.displayStandard(
-        headerBuffer,
-        line1Buffer,
-        line2Buffer,
-        line3Buffer, 
-        line4Buffer);
+    // Redraw and send only what changed.
+    display.render(lastUpdateTime);
   }
 }
@@ -2,33 +2,51 @@
 #include "MonorailSystem.h"
 
 #define BLINK_OFFSET 100
+#define BLINK_OFFSET_ORANGE 250
+#define BLINK_DURATION 1000
 
 
 /*
+ * The blink state: each pole's yellow light on for a second in two, BLINK_OFFSET behind the
+ * pole before it, and its orange one BLINK_OFFSET_ORANGE behind the yellow. Channel 2i is
+ * pole i's yellow light, 2i+1 its orange one.
  */
-void monorail_pole_setup(MonorailPole *pole, int startPin, int offsetYellow, int offsetOrange, SeaRobLight::LightState lstate) {
-  pole->_lightYellow = new SeaRobLight(startPin, offsetYellow);
-  pole->_lightYellow->UpdateState(lstate);
-  
-  pole->_lightOrange = new SeaRobLight(startPin + 1, offsetOrange);
-  pole->_lightOrange->UpdateState(lstate);
-}
-
+#define MONORAIL_BLINK_TRACK(channel, onTime) \
+  { 0, (channel), 0, SeaRobTimeline::Step }, \
+  { (onTime), (channel), 255, SeaRobTimeline::Step }, \
+  { (onTime) + BLINK_DURATION, (channel), 0, SeaRobTimeline::Step }
+
+#define MONORAIL_BLINK_POLE(pole) \
+  MONORAIL_BLINK_TRACK((pole) * 2, (pole) * BLINK_OFFSET), \
+  MONORAIL_BLINK_TRACK(((pole) * 2) + 1, ((pole) * BLINK_OFFSET) + BLINK_OFFSET_ORANGE)
+
+static const SeaRobKeyframe monorailBlinkKeys[] PROGMEM = {
+  MONORAIL_BLINK_POLE(0),
+  MONORAIL_BLINK_POLE(1),
+  MONORAIL_BLINK_POLE(2),
+  MONORAIL_BLINK_POLE(3),
+  MONORAIL_BLINK_POLE(4),
+  MONORAIL_BLINK_POLE(5),
+  MONORAIL_BLINK_POLE(6),
+};
 
 
 /*
  */
-void monorail_pole_destroy(MonorailPole *pole) {
-  delete pole->_lightYellow;
-  delete pole->_lightOrange;
+void monorail_pole_setup(MonorailPole *pole, int startPin, SeaRobLight::LightState lstate) {
+  pole->_lightYellow.Attach(startPin, false);
+  pole->_lightYellow.UpdateState(lstate);
+  
+  pole->_lightOrange.Attach(startPin + 1, false);
+  pole->_lightOrange.UpdateState(lstate);
 }
 
+
 /*
- * 
+ * The lights and the blink timeline are run by SeaRobScheduler; this is only for polling by hand.
  */
-void monorail_pole_loop(MonorailPole *pole, unsigned long updateTime) {
-  pole->_lightYellow->ProcessLoop(updateTime);
-  pole->_lightOrange->ProcessLoop(updateTime);
+void monorail_system_loop(MonorailSystem *monorail, unsigned long updateTime) {
+  monorail->_blinkTimeline->ProcessLoop(updateTime);
 }
 
 
@@ -40,33 +58,25 @@ void monorail_system_setup(MonorailSystem *monorail, int startPin) {
   monorail->_lightState = SeaRobLight::LightState::Off;
   monorail->_lightStateStartTime = 0;
 
+  monorail->_blinkTimeline = new SeaRobTimeline(monorailBlinkKeys, 
+    sizeof(monorailBlinkKeys) / sizeof(monorailBlinkKeys[0]), 2 * BLINK_DURATION);
   for (int i = 0 ; i < MONORAIL_POLE_COUNT_SLAB1 ; i++) {
-    monorail_pole_setup(&(monorail->_poles_slab1[i]), monorail->_pinStart + (i * 2), 0, 0, monorail->_lightState);
+    MonorailPole *pole = &(monorail->_poles_slab1[i]);
+    monorail_pole_setup(pole, monorail->_pinStart + (i * 2), monorail->_lightState);
+    monorail->_blinkTimeline->BindLight(i * 2, &(pole->_lightYellow));
+    monorail->_blinkTimeline->BindLight((i * 2) + 1, &(pole->_lightOrange));
   }
 }
 
 
-/*
- * 
- */
-void monorail_system_loop(MonorailSystem *monorail, unsigned long updateTime) {
-  for (int i = 0 ; i < MONORAIL_POLE_COUNT_SLAB1 ; i++) {
-    monorail_pole_loop(&(monorail->_poles_slab1[i]), updateTime);
-  }
-}
-
 /*
  * Called every streetlight control button-down.
  */
 void monorail_system_state_increment(MonorailSystem *monorail, unsigned long updateTime) {
 
   // Cycle through the available states.
-  int blinkOffset = 0;
-  int blinkOffsetOrangeDelta = 0;
   switch (monorail->_lightState) {
     case SeaRobLight::LightState::On:
-      blinkOffset = BLINK_OFFSET;
-      blinkOffsetOrangeDelta = 250;
       monorail->_lightState = SeaRobLight::LightState::UniformBlink;
       break;
       
@@ -80,13 +90,18 @@ void monorail_system_state_increment(MonorailSystem *monorail, unsigned long upd
       break;
   }
 
-  // Record start time of state machine, and re-init all the lights.
+  // Record start time of state machine; blinking is the timeline's, steady states the lights' own.
   monorail->_lightStateStartTime = updateTime;
-  for (int i = 0 ; i < MONORAIL_POLE_COUNT_SLAB1 ; i++) {
-    monorail_pole_setup(&(monorail->_poles_slab1[i]), monorail->_pinStart + (i * 2), 
-      (i * blinkOffset), (i * blinkOffset) + blinkOffsetOrangeDelta, monorail->_lightState);
+  if (monorail->_lightState == SeaRobLight::LightState::UniformBlink) {
+    monorail->_blinkTimeline->Play(updateTime, SeaRobTimeline::Loop);
+  } else {
+    monorail->_blinkTimeline->Stop();
+    for (int i = 0 ; i < MONORAIL_POLE_COUNT_SLAB1 ; i++) {
+      monorail->_poles_slab1[i]._lightYellow.UpdateState(monorail->_lightState);
+      monorail->_poles_slab1[i]._lightOrange.UpdateState(monorail->_lightState);
+    }
   }
 
   Serial.print(F("monorail light state now: "));
   Serial.println(monorail->_lightState);
-} 
+}
@@ -2,12 +2,14 @@
 #define __Monorail_h__
 
 #include "SeaRobLight.h"
+#include "SeaRobLightBank.h"
+#include "SeaRobTimeline.h"
 
 #define MONORAIL_POLE_COUNT_SLAB1         7
 
 struct MonorailPole {
-  SeaRobLight *       _lightYellow;
-  SeaRobLight *       _lightOrange;
+  SeaRobLightHandle   _lightYellow;
+  SeaRobLightHandle   _lightOrange;
 
   unsigned long       blinkTime;
   bool                blinkState;
@@ -23,6 +25,7 @@ struct MonorailSystem {
     unsigned long             _lightStateStartTime;
     
     MonorailPole              _poles_slab1[MONORAIL_POLE_COUNT_SLAB1];
+    SeaRobTimeline *          _blinkTimeline; // plays the blink state across every pole
 };
 
 
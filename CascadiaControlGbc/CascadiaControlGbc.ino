@@ -1,7 +1,11 @@
 #include "Arduino.h"
+#include "SeaRobArena.h"
 #include "SeaRobDisplay.h"
 #include "SeaRobLight.h"
 #include "SeaRobLogger.h"
+#include "SeaRobOutput.h"
+#include "SeaRobProfiler.h"
+#include "SeaRobScheduler.h"
 #include "SeaRobSpringButton.h"
 #include "SeaRobSpringButtonLightList.h"
 
@@ -28,9 +32,15 @@ const char      buildTimestamp[] =  __DATE__ " " __TIME__;
 const char      buildDatestamp[] = __DATE__;
 
 
-// Globals: OLED Display subsystem, connected via I2C interface
+// Globals: OLED Display subsystem, connected via I2C interface (hardware TWI pins)
 boolean useDisplay = true; 
-SeaRobDisplay display(PIN_I2C_SDA, PIN_I2C_SCL);
+SeaRobDisplay display(PIN_I2C_SDA, PIN_I2C_SCL, SeaRobDisplay::Transport::HardwareTwi);
+
+
+// Globals: Loop profiler; send 'p' over the Serial Monitor for a dump, 'r' to reset.
+int profileLoop = -1;
+int profilePFLight = -1;
+int profileDisplay = -1;
 
 
 // Globals: PowerFunctions (PF) Lights
@@ -48,22 +58,30 @@ void setup() {
   startTime = millis();
   
   // Init the serial line; important for debug messages back to the Arduino Serial Monitor.
-  Serial.begin(9600);
+  bclogger_setup();
   bclogger(""); // Skip line to seperate from last instance of the program.
   bclogger("setup: begin \"%s\" (build: %s)", buildName.c_str(), buildTimestamp);
 
   if (useDisplay) {
     bclogger("setup: OLED start...");
     display.setup(buildTimestamp);
+    display.setupStandardLayout();
+    display.setField(SeaRobDisplay::Header, "connolly light ctrl");
     bclogger("setup: OLED complete");
   }
 
   if (usePFLight) {
     bclogger("setup: pf-light starting with maxLights=%d", MAX_LIGHTS);
-	  buttonLightList = new SeaRobSpringButtonLightList(String("gbc light list"), MAX_LIGHTS, PIN_PF_LIGHT_BUTTON_1, PIN_PF_LIGHT_CTRL_1, PIN_PF_LIGHT_MODE_SELECTOR);
+	  buttonLightList = new SeaRobSpringButtonLightList(F("gbc light list"), MAX_LIGHTS, PIN_PF_LIGHT_BUTTON_1, PIN_PF_LIGHT_CTRL_1, PIN_PF_LIGHT_MODE_SELECTOR);
   }
   
+  profileLoop = SeaRobProfiler::AddSection(F("loop"));
+  profilePFLight = SeaRobProfiler::AddSection(F("pf-light"));
+  profileDisplay = SeaRobProfiler::AddSection(F("display"));
+  
+  SeaRobArena::Freeze(); // the object graph is built; nothing allocates after this
   bclogger("setup: complete for \"%s\"", buildName.c_str());
+  bclogger_setAsync(true); // from here on the loop never waits on the Serial Monitor
 }
 
 
@@ -75,41 +93,42 @@ void loop() {
 
   // Get the current time.
   lastUpdateTime = millis();
+  SeaRobProfileScope loopScope(profileLoop);
+  SeaRobProfiler::ProcessSerialCommand();
+  bclogger_drain();
   //bclogger("loop: called with \"%00d\"", lastUpdateTime);
 
   if (usePFLight) {
-    buttonLightList->ProcessLoop(lastUpdateTime);
+    SeaRobProfileScope scope(profilePFLight);
+    SeaRobScheduler::Service(lastUpdateTime);
   } 
 
-  if (useDisplay) {
-      // Update the OLED screen with our current state.
+  // The lights only staged their pins; switch them all now, before the display gets its turn.
+  SeaRobOutput::Commit();
 
-      char headerBuffer[50];
-      snprintf(headerBuffer, 50, "connolly light ctrl");
-      
+  if (useDisplay) {
+    SeaRobProfileScope scope(profileDisplay);
+    
+    // Update the OLED screen with our current state; fields are only re-formatted at the display's refresh rate.
+    if (display.isRefreshDue(lastUpdateTime)) {
       // Format the Uptime.
-      int upSecs = (lastUpdateTime - startTime) / 1000;
-      char line1Buffer[50];
-      snprintf(line1Buffer, 50, "%09d %s", upSecs, buildDatestamp);
+      unsigned long upSecs = (lastUpdateTime - startTime) / 1000;
+      display.setFieldf(SeaRobDisplay::Line1, "%09lu %s", upSecs, buildDatestamp);
 
-      char line2Buffer[50];
-      snprintf(line2Buffer, 50, "");
-      
-      char line3Buffer[50];
-      snprintf(line3Buffer, 50, "");
+      // Loop timing.
+      char profileBuffer[DISPLAY_FIELD_CHARS + 1];
+      SeaRobProfiler::GetOverlayString(profileLoop, profileBuffer, sizeof(profileBuffer));
+      display.setField(SeaRobDisplay::Line2, profileBuffer);
 
       // PF-Light monitoring
       char line4Buffer[50];
-      strcat(line4Buffer, "lit: ");
+      strcpy(line4Buffer, "lit: ");
       int litstrlen = strlen(line4Buffer);
       buttonLightList->GetStatusString(line4Buffer + litstrlen, 50 - litstrlen);
+      display.setField(SeaRobDisplay::Line4, line4Buffer);
+    }
 
-      // Send to the display.
-      display.displayStandard(
-        headerBuffer,
-        line1Buffer,
-        line2Buffer,
-        line3Buffer, 
-        line4Buffer); 
+    // Redraw and send only what changed.
+    display.render(lastUpdateTime);
   }
 }
@@ -1,7 +1,11 @@
 #include "Arduino.h"
+#include "SeaRobArena.h"
 #include "SeaRobDisplay.h"
 #include "SeaRobLight.h"
 #include "SeaRobLogger.h"
+#include "SeaRobOutput.h"
+#include "SeaRobProfiler.h"
+#include "SeaRobScheduler.h"
 #include "SeaRobSpringButton.h"
 #include "SeaRobSpringButtonLightList.h"
 
@@ -34,6 +38,10 @@
 #define PIN_TRAIN_MOTOR_ENB         3  // Digital PWM Pin, output
 #define PIN_TRAIN_SLIDER            A1 // Analog Pin, input (experimental)
 
+// Constants: Motor ramps, in pulse width per second at the steepest
+#define WINDMILL_RAMP_ACCELERATION  120
+#define TRAIN_RAMP_ACCELERATION     80
+
 // Constants: Lego PowerFunctions Light Array
 #define MAX_PF_LIGHTS               5
 #define PIN_PF_LIGHT_BUTTON_1       30 // Digital Pin, input  [30-34]
@@ -62,9 +70,18 @@ const char      buildTimestamp[] =  __DATE__ " " __TIME__;
 const char      buildDatestamp[] = __DATE__;
 
 
-// Globals: OLED Display subsystem, connected via I2C interface
+// Globals: OLED Display subsystem, connected via I2C interface (hardware TWI pins)
 boolean useDisplay = true; 
-SeaRobDisplay display(PIN_I2C_SDA, PIN_I2C_SCL);
+SeaRobDisplay display(PIN_I2C_SDA, PIN_I2C_SCL, SeaRobDisplay::Transport::HardwareTwi);
+
+
+// Globals: Loop profiler; send 'p' over the Serial Monitor for a dump, 'r' to reset.
+boolean useProfilerOverlay = false; // show loop timing on the OLED, in place of the windmill line
+int     profileLoop = -1;
+int     profileWindmill = -1;
+int     profileTrain = -1;
+int     profileObjects = -1;
+int     profileDisplay = -1;
 
 
 // Globals: Windmill subsystem.
@@ -217,26 +234,29 @@ void setup() {
   startTime = millis();
   
   // Init the serial line; important for debug messages back to the Arduino Serial Monitor.
-  Serial.begin(9600);
+  bclogger_setup();
   bclogger(""); // Skip line to seperate from last instance of the program.
   bclogger("setup: begin \"%s\" (build: %s)", buildName.c_str(), buildTimestamp);
 
   if (useDisplay) {
     bclogger("setup: OLED start...");
     display.setup(buildTimestamp);
+    display.setupStandardLayout();
+    display.setField(SeaRobDisplay::Header, "coolguybri cntrl 3.5");
     bclogger("setup: OLED complete");
   }
 
   if (useWindmill) {
     bclogger("setup: windmill start...");
     
-    motor_setup(&motorWindmill, "windmill", PIN_WINDMILL_MOTOR_IN1, PIN_WINDMILL_MOTOR_IN2, PIN_WINDMILL_MOTOR_ENB);
+    motor_setup(&motorWindmill, F("windmill"), PIN_WINDMILL_MOTOR_IN1, PIN_WINDMILL_MOTOR_IN2, PIN_WINDMILL_MOTOR_ENB);
+    motor_set_ramp(&motorWindmill, MotorRamp_Trapezoidal, WINDMILL_RAMP_ACCELERATION);
     windmillVelocity = motor_set_pulsewidth(&motorWindmill, windmillVelocity); // middle value.
     
-    buttonWindmillPwr = new SeaRobSpringButton("windmill power", PIN_WINDMILL_BUTTON_PWR, true, &onButtonDownWindmillPwr);
-    buttonWindmillDir = new SeaRobSpringButton("windmill direction", PIN_WINDMILL_BUTTON_DIR, true, &onButtonDownWindmillDir);
-    buttonWindmillInc = new SeaRobSpringButton("windmill speed inc", PIN_WINDMILL_BUTTON_INC, true, &onButtonDownWindmillInc);
-    buttonWindmillDec = new SeaRobSpringButton("windmill speed dec", PIN_WINDMILL_BUTTON_DEC, true, &onButtonDownWindmillDec);
+    buttonWindmillPwr = new SeaRobSpringButton(F("windmill power"), PIN_WINDMILL_BUTTON_PWR, true, &onButtonDownWindmillPwr);
+    buttonWindmillDir = new SeaRobSpringButton(F("windmill direction"), PIN_WINDMILL_BUTTON_DIR, true, &onButtonDownWindmillDir);
+    buttonWindmillInc = new SeaRobSpringButton(F("windmill speed inc"), PIN_WINDMILL_BUTTON_INC, true, &onButtonDownWindmillInc);
+    buttonWindmillDec = new SeaRobSpringButton(F("windmill speed dec"), PIN_WINDMILL_BUTTON_DEC, true, &onButtonDownWindmillDec);
 
     bclogger("setup: windmill complete, power=%d, dir=%d, speed=%d/255", windmillPower, windmillDirection, windmillVelocity);
   }
@@ -244,14 +264,15 @@ void setup() {
   if (useTrain) {
     bclogger("setup: train start...");
     
-    motor_setup(&motorTrain, "train", PIN_TRAIN_MOTOR_IN1, PIN_TRAIN_MOTOR_IN2, PIN_TRAIN_MOTOR_ENB);
+    motor_setup(&motorTrain, F("train"), PIN_TRAIN_MOTOR_IN1, PIN_TRAIN_MOTOR_IN2, PIN_TRAIN_MOTOR_ENB);
+    motor_set_ramp(&motorTrain, MotorRamp_SCurve, TRAIN_RAMP_ACCELERATION);
     trainVelocity = motor_set_pulsewidth(&motorTrain, trainVelocity); // middle value.
     
-    buttonTrainPwr = new SeaRobSpringButton("train power", PIN_TRAIN_BUTTON_PWR, true, &onButtonDownTrainPwr);
-    buttonTrainDir = new SeaRobSpringButton("train direction", PIN_TRAIN_BUTTON_DIR, true, &onButtonDownTrainDir);
-    buttonTrainInc = new SeaRobSpringButton("train up", PIN_TRAIN_BUTTON_INC, true, &onButtonDownTrainInc);
-    buttonTrainDec = new SeaRobSpringButton("train down", PIN_TRAIN_BUTTON_DEC, true, &onButtonDownTrainDec);
-    //sliderinput_setup(&sliderTrain, "train velocity", PIN_TRAIN_SLIDE, true, &onSliderChangeTrain);
+    buttonTrainPwr = new SeaRobSpringButton(F("train power"), PIN_TRAIN_BUTTON_PWR, true, &onButtonDownTrainPwr);
+    buttonTrainDir = new SeaRobSpringButton(F("train direction"), PIN_TRAIN_BUTTON_DIR, true, &onButtonDownTrainDir);
+    buttonTrainInc = new SeaRobSpringButton(F("train up"), PIN_TRAIN_BUTTON_INC, true, &onButtonDownTrainInc);
+    buttonTrainDec = new SeaRobSpringButton(F("train down"), PIN_TRAIN_BUTTON_DEC, true, &onButtonDownTrainDec);
+    //sliderinput_setup(&sliderTrain, F("train velocity"), PIN_TRAIN_SLIDE, true, &onSliderChangeTrain);
 
     bclogger("setup: train complete, power=%d, dir=%d, speed=%d/255", trainPower, trainDirection, trainVelocity);
   }
@@ -261,7 +282,7 @@ void setup() {
 
     int buttonPins[] = { 30, 31, 32, 33, 34 }; // PIN_PF_LIGHT_BUTTON_1
     int lightPins[] = { 40, 41, 44, 43, 42 }; // PIN_PF_LIGHT_CTRL_1 - dealing with swapped physical wiring
-    buttonLightList = new SeaRobSpringButtonLightList(String("rooftop lights"), MAX_PF_LIGHTS, buttonPins, lightPins, PIN_PF_LIGHT_MODE_SELECTOR);
+    buttonLightList = new SeaRobSpringButtonLightList(F("rooftop lights"), MAX_PF_LIGHTS, buttonPins, lightPins, PIN_PF_LIGHT_MODE_SELECTOR);
     
     bclogger("setup: pf-light complete");
   }
@@ -269,19 +290,20 @@ void setup() {
   if (useUSBLight) {
     bclogger("setup: usb-light starting");
 
-    frontLights = new SeaRobSpringButtonLight("front row street lights", 
+    frontLights = new SeaRobSpringButtonLight(F("front row street lights"), 
         PIN_BRICKSTUFF_STREETLIGHT_BUTTON, PIN_BRICKSTUFF_STREETLIGHT_CTRL, false, true,
         onButtonDownFrontUsbLight);
     frontLights->GetLight()->ToggleOnOff(); // Default to on at startup.
         
-    stormRedBeamLight = new SeaRobSpringButtonLight("storm-redbeam", 
+    stormRedBeamLight = new SeaRobSpringButtonLight(F("storm-redbeam"), 
         PIN_BRICKSTUFF_STORM_REDBEAM_BUTTON, PIN_BRICKSTUFF_STORM_REDBEAM_CTRL, true, true,
         onButtonDownStormRedBeamLight);
     stormRedBeamLight->GetLight()->UpdateBlinkConfig(0, 0, STORM_RED_DURATION_ON, STORM_RED_DURATION_OFF, 
         false, STORM_RED_DURATION_FADE, STORM_RED_DURATION_FADE);
+    stormRedBeamLight->GetLight()->SetFadeCurve(SeaRobFade::Gamma);
     stormRedBeamLight->GetLight()->UpdateState(SeaRobLight::LightState::UniformBlink);
       
-    stormInternalLight = new SeaRobSpringButtonLight("storm-internal", 
+    stormInternalLight = new SeaRobSpringButtonLight(F("storm-internal"), 
         PIN_BRICKSTUFF_STORM_INTERNAL_BUTTON, PIN_BRICKSTUFF_STORM_INTERNAL_CTRL, false, true,
         onButtonDownStormInternalLight);
 
@@ -289,7 +311,14 @@ void setup() {
   }
 
   // Init the rest of our internal state.
+  profileLoop = SeaRobProfiler::AddSection(F("loop"));
+  profileWindmill = SeaRobProfiler::AddSection(F("windmill"));
+  profileTrain = SeaRobProfiler::AddSection(F("train"));
+  profileObjects = SeaRobProfiler::AddSection(F("objects"));
+  profileDisplay = SeaRobProfiler::AddSection(F("display"));
+  SeaRobArena::Freeze(); // the object graph is built; nothing allocates after this
   bclogger("setup: complete for \"%s\"", buildName.c_str());
+  bclogger_setAsync(true); // from here on the loop never waits on the Serial Monitor
 }
 
 
@@ -301,63 +330,55 @@ void loop() {
 
   // Get the current time.
   lastUpdateTime = millis();
+  SeaRobProfileScope loopScope(profileLoop);
+  SeaRobProfiler::ProcessSerialCommand();
+  bclogger_drain();
+
+  // Every button is polled, but lights only run when one of their blink or fade steps is due.
+  {
+      SeaRobProfileScope scope(profileObjects);
+      SeaRobScheduler::Service(lastUpdateTime);
+  }
 
   if (useWindmill) {
-      // Process inputs first so they have immediate impact.
-      buttonWindmillPwr->ProcessLoop(lastUpdateTime);
-      buttonWindmillDir->ProcessLoop(lastUpdateTime);
-      buttonWindmillInc->ProcessLoop(lastUpdateTime);
-      buttonWindmillDec->ProcessLoop(lastUpdateTime);
-    
-      // Increment the rest of the state machines.
+      SeaRobProfileScope scope(profileWindmill);
       motor_loop(&motorWindmill, lastUpdateTime);
   }
 
   if (useTrain) {
-      // Process inputs first so they have immediate impact.
-      buttonTrainPwr->ProcessLoop(lastUpdateTime);
-      buttonTrainDir->ProcessLoop(lastUpdateTime);
-      buttonTrainInc->ProcessLoop(lastUpdateTime);
-      buttonTrainDec->ProcessLoop(lastUpdateTime);
+      SeaRobProfileScope scope(profileTrain);
       //sliderinput_loop(&sliderTrain, lastUpdateTime);
-
-      // Increment the rest of the state machines.
       motor_loop(&motorTrain, lastUpdateTime);
   }
 
-  if (usePFLight) {
-    buttonLightList->ProcessLoop(lastUpdateTime);
-  }
-
-  if (useUSBLight) {
-    frontLights->ProcessLoop(lastUpdateTime);
-    stormRedBeamLight->ProcessLoop(lastUpdateTime);
-    stormInternalLight->ProcessLoop(lastUpdateTime);
-  }
+  // Everything above only staged its pins; switch them all now, before the display gets its turn.
+  SeaRobOutput::Commit();
 
   if (useDisplay) {
-      // Update the OLED screen with our current state.
-
-      #define LINE_BUFFER_SIZE 50
-      char headerBuffer[LINE_BUFFER_SIZE];
-      snprintf(headerBuffer, LINE_BUFFER_SIZE, "coolguybri cntrl 3.5");
-      
+    SeaRobProfileScope scope(profileDisplay);
+    
+    // Update the OLED screen with our current state; fields are only re-formatted at the display's refresh rate.
+    if (display.isRefreshDue(lastUpdateTime)) {
       // Format the Uptime.
       unsigned long upSecs = (lastUpdateTime - startTime) / 1000;
-      char line1Buffer[LINE_BUFFER_SIZE];
-      snprintf(line1Buffer, LINE_BUFFER_SIZE, "%09lu %s", upSecs, buildDatestamp);
+      display.setFieldf(SeaRobDisplay::Line1, "%09lu %s", upSecs, buildDatestamp);
 
-       // Train monitoring
-      char line2Buffer[LINE_BUFFER_SIZE];
-      snprintf(line2Buffer, LINE_BUFFER_SIZE, "t [%c] %s %d%%", 
+      // Train monitoring
+      display.setFieldf(SeaRobDisplay::Line2, "t [%c] %s %d%%", 
           trainPower ? '*' : ' ', trainDirection ? "<-" : "->", (trainVelocity * 100) / 255);
           
-      // Windmill monitoring.
-      char line3Buffer[LINE_BUFFER_SIZE];
-      snprintf(line3Buffer, LINE_BUFFER_SIZE, "w [%c] %s %d%%", 
-          windmillPower ? '*' : ' ', windmillDirection ? "<-" : "->", (windmillVelocity * 100) / 255);
+      // Windmill monitoring, or the loop timing.
+      if (useProfilerOverlay) {
+        char profileBuffer[DISPLAY_FIELD_CHARS + 1];
+        SeaRobProfiler::GetOverlayString(profileLoop, profileBuffer, sizeof(profileBuffer));
+        display.setField(SeaRobDisplay::Line3, profileBuffer);
+      } else {
+        display.setFieldf(SeaRobDisplay::Line3, "w [%c] %s %d%%", 
+            windmillPower ? '*' : ' ', windmillDirection ? "<-" : "->", (windmillVelocity * 100) / 255);
+      }
 
       // PF-Light monitoring
+      #define LINE_BUFFER_SIZE 50
       char line4Buffer[LINE_BUFFER_SIZE];
       strcpy(line4Buffer, "l ");
       int litstrlen = strlen(line4Buffer);
@@ -370,13 +391,10 @@ void loop() {
         stormRedBeamLight->IsOn() ? '*' : 'o',
         stormInternalLight->IsOn() ? '*' : 'o',
         false ? '*' : 'o'); // TODO: add new button
+      display.setField(SeaRobDisplay::Line4, line4Buffer);
+    }
 
-      // Send to the display.
-      display.displayStandard(
-        headerBuffer,
-        line1Buffer,
-        line2Buffer,
-        line3Buffer, 
-        line4Buffer);
+    // Redraw and send only what changed.
+    display.render(lastUpdateTime);
   }
 }
@@ -1,11 +1,12 @@
 #include "Arduino.h"
+#include "SeaRobFade.h"
 #include "SeaRobLogger.h"
 #include "MotorPCM.h"
 
 /*
  * 
  */
-void motor_setup(struct MotorPCM *m, String name, int pinInput1, int pinInput2, int pinEnable) {
+void motor_setup(struct MotorPCM *m, const __FlashStringHelper *name, int pinInput1, int pinInput2, int pinEnable) {
   m->name = name;
   m->motorState = MotorState_Off;
   m->motorPulseWidth = 0;
@@ -13,33 +14,140 @@ void motor_setup(struct MotorPCM *m, String name, int pinInput1, int pinInput2,
   m->pin_input2 = pinInput2;
   m->pin_enable = pinEnable;
   
-  pinMode(m->pin_input1, OUTPUT);
-  pinMode(m->pin_input2, OUTPUT);
+  m->lastPulseWidth = -1;
+  
+  m->rampProfile = MotorRamp_None;
+  m->rampAcceleration = 255;
+  m->rampVelocity = 0;
+  m->rampFrom = 0;
+  m->rampTo = 0;
+  m->rampStart = 0;
+  m->rampMillis = 0;
+  m->rampRate = SeaRobFade::Rate(0);
+  
+  m->out_input1 = SeaRobOutput::Attach(m->pin_input1);
+  m->out_input2 = SeaRobOutput::Attach(m->pin_input2);
   pinMode(m->pin_enable, OUTPUT);
 
-  bclogger("motor_setup: \"%s\" pins: in1=%d, in2=%d, enb=%d, state=%d",
-    m->name.c_str(), m->pin_input1, m->pin_input2, m->pin_enable, m->motorState);
+  bclogger("motor_setup: \"%S\" pins: in1=%d, in2=%d, enb=%d, state=%d",
+    m->name, m->pin_input1, m->pin_input2, m->pin_enable, m->motorState);
 }
 
 /*
- * 
+ * Where the driven speed heads next: straight for the target, unless that means changing
+ * direction, which goes through a stop.
  */
-void motor_loop(MotorPCM *m, unsigned long updateTime) {  
-  int in1 = LOW;
-  int in2 = LOW;
+static int motor_waypoint(int velocity, int target) {
+  if (((velocity > 0) && (target < 0)) || ((velocity < 0) && (target > 0))) {
+    return 0;
+  }
+  return target;
+}
+
+/*
+ * Share of the ramp covered (0-255) for progress through its time (0-255).
+ */
+static uint8_t motor_ramp_level(MotorRampProfile profile, uint8_t progress) {
+  switch (profile) {
+  case MotorRamp_Trapezoidal:
+    // Acceleration a ramp of 4/3 over the middle half, 0 at the ends; 1/6 done by the first
+    // quarter, 5/6 by the last.
+    if (progress < 64) {
+      return ((unsigned long) progress * progress * 85) >> 13;
+    }
+    if (progress < 192) {
+      return 42 + (((unsigned long) (progress - 64) * 340) >> 8);
+    }
+    return 255 - (((unsigned long) (256 - progress) * (256 - progress) * 85) >> 13);
+  case MotorRamp_SCurve:
+    return SeaRobFade::Level(SeaRobFade::EaseInOut, progress);
+  case MotorRamp_Linear:
+  default:
+    return progress;
+  }
+}
+
+/*
+ * How long a ramp of delta takes, so that its steepest part is the configured acceleration:
+ * 1, 4/3 and pi/2 times as long as a linear one.
+ */
+static unsigned int motor_ramp_millis(MotorPCM *m, int delta) {
+  unsigned long millis = (unsigned long) abs(delta) * 1000UL / m->rampAcceleration;
+  switch (m->rampProfile) {
+  case MotorRamp_Trapezoidal:
+    return (millis * 4) / 3;
+  case MotorRamp_SCurve:
+    return (millis * 201) >> 7;
+  default:
+    return millis;
+  }
+}
+
+/*
+ * One step of the ramp towards what was asked for. A new target starts a new ramp from
+ * wherever the motor has got to.
+ */
+static void motor_ramp(MotorPCM *m, unsigned long updateTime) {
+  int target = 0;
   switch (m->motorState) {
+  case MotorState_Off:
+      break;
   case MotorState_Forward:
-      in1 = HIGH;
+      target = m->motorPulseWidth;
       break;
   case MotorState_Reverse:
-      in2 = HIGH;
+      target = -m->motorPulseWidth;
       break;
   }
   
-  // write out current state.
-  digitalWrite(m->pin_input1, in1);
-  digitalWrite(m->pin_input2, in2);
-  analogWrite(m->pin_enable, m->motorPulseWidth);
+  int waypoint = motor_waypoint(m->rampVelocity, target);
+  if (waypoint != m->rampTo) {
+    m->rampFrom = m->rampVelocity;
+    m->rampTo = waypoint;
+    m->rampStart = updateTime;
+    m->rampMillis = motor_ramp_millis(m, m->rampTo - m->rampFrom);
+    m->rampRate = SeaRobFade::Rate(m->rampMillis);
+    bclogger("motor_ramp: \"%S\" %d to %d in %ums", m->name, m->rampFrom, m->rampTo, m->rampMillis);
+  }
+  if (m->rampVelocity == m->rampTo) {
+    return;
+  }
+  
+  unsigned long elapsed = (uint32_t) (updateTime - m->rampStart);
+  uint8_t level = motor_ramp_level(m->rampProfile, SeaRobFade::Progress(m->rampRate, elapsed, m->rampMillis));
+  m->rampVelocity = m->rampFrom + ((long) (m->rampTo - m->rampFrom) * level) / 255;
+}
+
+/*
+ * 
+ */
+void motor_loop(MotorPCM *m, unsigned long updateTime) {  
+  int in1 = LOW;
+  int in2 = LOW;
+  int pulseWidth = m->motorPulseWidth;
+  if (m->rampProfile == MotorRamp_None) {
+    switch (m->motorState) {
+    case MotorState_Forward:
+        in1 = HIGH;
+        break;
+    case MotorState_Reverse:
+        in2 = HIGH;
+        break;
+    }
+  } else {
+    motor_ramp(m, updateTime);
+    in1 = (m->rampVelocity > 0) ? HIGH : LOW;
+    in2 = (m->rampVelocity < 0) ? HIGH : LOW;
+    pulseWidth = abs(m->rampVelocity);
+  }
+  
+  // Stage the direction pins for the loop's commit; both switch together.
+  SeaRobOutput::Write(m->out_input1, in1);
+  SeaRobOutput::Write(m->out_input2, in2);
+  if (pulseWidth != m->lastPulseWidth) {
+    analogWrite(m->pin_enable, pulseWidth);
+    m->lastPulseWidth = pulseWidth;
+  }
 }
 
 /*
@@ -47,7 +155,7 @@ void motor_loop(MotorPCM *m, unsigned long updateTime) {
  */
 void motor_set_state(MotorPCM *m, MotorPcmState ms) {
   m->motorState = ms;
-  bclogger("motor_set_state: \"%s\" state=%d", m->name.c_str(), m->motorState);
+  bclogger("motor_set_state: \"%S\" state=%d", m->name, m->motorState);
 }
 
 /*
@@ -61,6 +169,25 @@ int motor_set_pulsewidth(MotorPCM *m, int pulseWidth) {
     pulseWidth = 255;
   
   m->motorPulseWidth = pulseWidth;
-  bclogger("motor_set_pulsewidth: \"%s\" width=%d", m->name.c_str(), m->motorPulseWidth);
+  bclogger("motor_set_pulsewidth: \"%S\" width=%d", m->name, m->motorPulseWidth);
   return m->motorPulseWidth;
 }
+
+/*
+ * acceleration is in pulse width per second: 255 takes a linear ramp from stop to full speed
+ * in a second. MotorRamp_None goes back to jumping straight to the target.
+ */
+void motor_set_ramp(MotorPCM *m, MotorRampProfile profile, int acceleration) {
+  if (acceleration < MOTOR_RAMP_MIN_ACCELERATION) 
+    acceleration = MOTOR_RAMP_MIN_ACCELERATION;
+  
+  // Pick up from whatever is being driven now.
+  if ((profile != MotorRamp_None) && (m->rampProfile == MotorRamp_None)) {
+    m->rampVelocity = (m->motorState == MotorState_Forward) ? m->motorPulseWidth
+                    : (m->motorState == MotorState_Reverse) ? -m->motorPulseWidth : 0;
+    m->rampTo = m->rampVelocity;
+  }
+  m->rampProfile = profile;
+  m->rampAcceleration = acceleration;
+  bclogger("motor_set_ramp: \"%S\" profile=%d, acceleration=%d", m->name, m->rampProfile, m->rampAcceleration);
+}
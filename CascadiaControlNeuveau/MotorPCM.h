@@ -1,7 +1,8 @@
 #ifndef __MotorPCM_h__
 #define __MotorPCM_h__
 
-#include "arduino.h"
+#include "Arduino.h"
+#include "SeaRobOutput.h"
 
 typedef enum {
   MotorState_Off,
@@ -9,26 +10,55 @@ typedef enum {
   MotorState_Reverse,
 } MotorPcmState;
 
+// How the driven speed follows the one asked for. Each profile accelerates no harder than
+// the motor's rampAcceleration; the smoother ones take longer for it.
+typedef enum {
+  MotorRamp_None,         // jump straight to it
+  MotorRamp_Linear,       // constant acceleration throughout
+  MotorRamp_Trapezoidal,  // acceleration builds over the first quarter, eases off over the last
+  MotorRamp_SCurve,       // acceleration follows half a sine wave, no step at either end
+} MotorRampProfile;
+
+// Gentlest acceleration, in pulse width per second; a slower ramp would outlast SeaRobFade.
+#define MOTOR_RAMP_MIN_ACCELERATION   8
+
 
 /*
- * 
+ * An L298N-style motor channel: two direction pins and a PWM enable pin.
+ * motorState and motorPulseWidth are what was asked for; with a ramp profile set, motor_loop()
+ * moves the driven speed towards them a step at a time, without blocking. A change of
+ * direction decelerates to a stop first, then accelerates the other way.
  */
 struct MotorPCM {
-  String          name;
+  const __FlashStringHelper *name; // PROGMEM
   MotorPcmState   motorState;
   int             motorPulseWidth; // Between 0-255.
   
   int             pin_input1;
   int             pin_input2;
   int             pin_enable;
+  
+  SeaRobOutputPin out_input1;
+  SeaRobOutputPin out_input2;
+  int             lastPulseWidth; // last value given to analogWrite, or -1
+  
+  MotorRampProfile  rampProfile;
+  int             rampAcceleration; // pulse width per second, at the steepest
+  int             rampVelocity; // driven now: pulse width, negative in reverse
+  int             rampFrom; // the ramp in progress, or the last one
+  int             rampTo;
+  unsigned long   rampStart;
+  unsigned int    rampMillis;
+  unsigned long   rampRate; // see SeaRobFade::Rate()
 };
 
 
-void motor_setup(MotorPCM *m, String name, int pinInput1, int pinInput2, int pinEnable);
+void motor_setup(MotorPCM *m, const __FlashStringHelper *name, int pinInput1, int pinInput2, int pinEnable);
 void motor_loop(MotorPCM *m, unsigned long updateTime);
 
 void motor_set_state(MotorPCM *m, MotorPcmState ms);
 int motor_set_pulsewidth(MotorPCM *m, int pulseWidth);
+void motor_set_ramp(MotorPCM *m, MotorRampProfile profile, int acceleration);
 
 
 #endif // __MotorPCM_h__
@@ -6,7 +6,7 @@
 /**
  * 
  */
-void sliderinput_setup(SliderInput *input, String name, int pin, onSliderChange changeHandler) {
+void sliderinput_setup(SliderInput *input, const __FlashStringHelper *name, int pin, onSliderChange changeHandler) {
   // Init state.
   input->_name = name;
   input->_pin = pin;
@@ -17,7 +17,7 @@ void sliderinput_setup(SliderInput *input, String name, int pin, onSliderChange
    // line should be hooked up to our input pin.
   pinMode(input->_pin, INPUT);
   
-  bclogger("sliderinput: \"%s\" started on pin %d", input->_name.c_str(), input->_pin);
+  bclogger("sliderinput: \"%S\" started on pin %d", input->_name, input->_pin);
 } 
 
 /*
@@ -28,13 +28,13 @@ void sliderinput_loop(SliderInput *input, unsigned long updateTime) {
   int currRead = analogRead(input->_pin);   
   int diff = abs(currRead - input->_levelPrev);
   if (diff < 10) {
-    //bclogger("sliderinput: \"%s\" no change on pin %d level=%d", input->_name.c_str(), input->_pin, currRead);
+    //bclogger("sliderinput: \"%S\" no change on pin %d level=%d", input->_name, input->_pin, currRead);
     return;
   }
    
   // If this is a button-down event, trigger a state change for the street light subsystem.
-  bclogger("sliderinput: \"%s\" triggered change on pin %d, old=%d, new=%d, diff=%d", 
-    input->_name.c_str(), input->_pin, input->_levelPrev, currRead, diff);
+  bclogger("sliderinput: \"%S\" triggered change on pin %d, old=%d, new=%d, diff=%d", 
+    input->_name, input->_pin, input->_levelPrev, currRead, diff);
   input->_onChangeHandler(input, currRead, updateTime);
 
   // Update the state.
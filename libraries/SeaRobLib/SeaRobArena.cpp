@@ -0,0 +1,74 @@
+#include "Arduino.h"
+#include "SeaRobArena.h"
+#include "SeaRobInput.h"
+#include "SeaRobLightBank.h"
+#include "SeaRobLogger.h"
+#include "SeaRobScheduler.h"
+#include "SeaRobSoftPwm.h"
+
+
+/* static class objects (global) */
+uint8_t SeaRobArena::s_block[SEAROB_ARENA_BYTES];
+size_t SeaRobArena::s_used = 0;
+size_t SeaRobArena::s_overflowBytes = 0;
+unsigned int SeaRobArena::s_allocations = 0;
+unsigned int SeaRobArena::s_lateAllocations = 0;
+bool SeaRobArena::s_frozen = false;
+
+
+/*
+ */
+void * SeaRobArena::Allocate(size_t size) {
+	s_allocations++;
+	if (s_frozen) {
+		s_lateAllocations++;
+		bclogger_error("SeaRobArena: %u bytes allocated after setup", (unsigned int) size);
+	}
+	
+	size_t rounded = (size + (ARENA_ALIGN - 1)) & ~((size_t) (ARENA_ALIGN - 1));
+	if (rounded > (SEAROB_ARENA_BYTES - s_used)) {
+		s_overflowBytes += rounded;
+		bclogger_error("SeaRobArena: full, %u bytes from the heap (%u over so far)", 
+			(unsigned int) size, (unsigned int) s_overflowBytes);
+		return malloc(size);
+	}
+	
+	void *block = &s_block[s_used];
+	s_used += rounded;
+	return block;
+}
+
+
+/*
+ */
+void SeaRobArena::Release(void *block) {
+	uint8_t *p = (uint8_t *) block;
+	if ((p < s_block) || (p >= (s_block + SEAROB_ARENA_BYTES))) {
+		free(block);
+	}
+}
+
+
+/*
+ */
+void SeaRobArena::Freeze() {
+	s_frozen = true;
+	bclogger("SeaRobArena: setup needed %u bytes, SEAROB_ARENA_BYTES is %u", 
+		(unsigned int) (s_used + s_overflowBytes), (unsigned int) SEAROB_ARENA_BYTES);
+	Dump();
+}
+
+
+/*
+ */
+void SeaRobArena::Dump() {
+	bclogger("SeaRobArena: %u of %u bytes in %u allocations, %u over to the heap, %u after setup", 
+		(unsigned int) s_used, (unsigned int) SEAROB_ARENA_BYTES, s_allocations, 
+		(unsigned int) s_overflowBytes, s_lateAllocations);
+	bclogger("SeaRobArena: scheduler timers peak %d of %d, inputs %d of %d, scanned pins %d of %d", 
+		SeaRobScheduler::GetTimerPeak(), SCHEDULER_MAX_TIMERS, SeaRobScheduler::GetInputCount(), SCHEDULER_MAX_INPUTS,
+		SeaRobInput::GetWatchCount(), INPUT_MAX_WATCHES);
+	bclogger("SeaRobArena: light bank %d of %d, soft pwm channels %d of %d", 
+		SeaRobLightBank::GetDefaultCount(), LIGHTBANK_MAX_LIGHTS, 
+		SeaRobSoftPwm::GetChannelCount(), SOFTPWM_MAX_CHANNELS);
+}
@@ -0,0 +1,54 @@
+#ifndef __searob_arena_h__
+#define __searob_arena_h__
+
+#include "Arduino.h"
+
+// On the Mega, the largest sketch (CascadiaControlNeuveau) builds 1532 bytes of objects;
+// Freeze() logs what a sketch needs, for setting this from the sketch's build flags.
+#ifndef SEAROB_ARENA_BYTES
+#if defined(__AVR__)
+#define SEAROB_ARENA_BYTES 		1664
+#else
+#define SEAROB_ARENA_BYTES 		16384 // host pointers and vtables are wider
+#endif
+#endif
+
+#define ARENA_ALIGN 			__BIGGEST_ALIGNMENT__
+
+
+/*
+ * Where the SeaRobLib object graph lives: one static block, handed out front to back while
+ * setup() builds the objects and never given back, so there is no heap to fragment and the
+ * memory shows up in the build's .bss figure instead of going missing at run time. Every
+ * SeaRobObject is allocated here by its operator new.
+ *
+ * Freeze() at the end of setup() marks the graph complete; anything allocated after it is
+ * logged as an error, being a run-time path that still allocates. A full arena falls back to
+ * malloc, also logged; Dump() says how much more SEAROB_ARENA_BYTES would have needed.
+ */
+class SeaRobArena {
+  public:
+  		static void *	Allocate(size_t size);
+  		// Arena memory is not reused; only memory that overflowed to malloc is freed.
+  		static void		Release(void *block);
+  		
+  		// Ends setup(): logs the bytes setup() needed and the report, and every later
+  		// allocation as an error.
+  		static void		Freeze();
+  		static bool		IsFrozen() { return s_frozen; }
+  		
+  		static size_t	GetUsed() { return s_used; }
+  		
+  		// Logs the arena, and the high-water marks of the fixed-size pools around SeaRobLib.
+  		static void		Dump();
+  		
+  private:
+  		static uint8_t	s_block[SEAROB_ARENA_BYTES] __attribute__((aligned(ARENA_ALIGN)));
+  		static size_t	s_used;
+  		static size_t	s_overflowBytes;
+  		static unsigned int	s_allocations;
+  		static unsigned int	s_lateAllocations;
+  		static bool		s_frozen;
+};
+
+#endif // __searob_arena_h__
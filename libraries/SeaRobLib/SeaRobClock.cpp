@@ -0,0 +1,52 @@
+#include "Arduino.h"
+#include "SeaRobClock.h"
+
+
+/* static class objects (global) */
+uint32_t SeaRobClock::s_last = 0;
+uint16_t SeaRobClock::s_wraps = 0;
+
+
+/*
+ */
+void SeaRobClock::Update(uint32_t now) {
+	if (now < s_last) {
+		s_wraps++;
+	}
+	s_last = now;
+}
+
+
+/*
+ * A millis() value on the unbroken timeline, taking it as the nearer of the times it could be
+ * around the last update.
+ */
+int64_t SeaRobClock::Extend(uint32_t time) {
+	int64_t last = ((int64_t) s_wraps << 32) | s_last;
+	return last + (int32_t) (time - s_last);
+}
+
+
+/*
+ */
+uint32_t SeaRobClock::Phase(uint32_t anchor, uint32_t period) {
+	if (period == 0) {
+		return 0;
+	}
+	int64_t phase = Extend(anchor) % (int64_t) period;
+	return (phase < 0) ? (uint32_t) (phase + period) : (uint32_t) phase;
+}
+
+
+/*
+ */
+uint32_t SeaRobClock::CycleStart(uint32_t now, uint32_t phase, uint32_t period) {
+	if (period == 0) {
+		return now;
+	}
+	int64_t into = (Extend(now) - phase) % (int64_t) period;
+	if (into < 0) {
+		into += period;
+	}
+	return now - (uint32_t) into;
+}
@@ -0,0 +1,48 @@
+#ifndef __searob_clock_h__
+#define __searob_clock_h__
+
+#include "Arduino.h"
+
+
+/*
+ * The one clock every animation keeps time by. A blink pattern is a cycle of period millis
+ * anchored somewhere on it, and its state at any moment is where now falls in that cycle,
+ * worked out afresh at each edge instead of by adding durations up. So nothing drifts, a
+ * stall of any length is made up in a single tick, and patterns anchored alike stay in step
+ * however late each of them was set up.
+ *
+ * millis() wraps every ~49.7 days. The clock counts the wraps (Service() keeps it posted), so
+ * a pattern's phase is taken on an unbroken timeline, once, when it is anchored or resumed.
+ * After that a pattern only measures from the start of its current cycle, which is never more
+ * than a period behind, in plain 32-bit arithmetic that wraps the same on the host as on the
+ * AVR. Anchors, like every deadline in SeaRobLib, must be within ~24 days of now.
+ */
+class SeaRobClock {
+  public:
+  		// Called with every Service() time, at least once every ~24 days.
+  		static void		Update(uint32_t now);
+
+  		// Where the start of the unbroken timeline falls in a cycle anchored at anchor.
+  		static uint32_t	Phase(uint32_t anchor, uint32_t period);
+  		// Start of the cycle, of that phase, that holds now.
+  		static uint32_t	CycleStart(uint32_t now, uint32_t phase, uint32_t period);
+
+  		// Millis into the cycle that holds now, moving *cycleStart up to it. One subtraction
+  		// while called every cycle or so; a division after a stall.
+  		static uint32_t	Elapsed(uint32_t now, uint32_t *cycleStart, uint32_t period) {
+  		  uint32_t elapsed = now - *cycleStart;
+  		  if (elapsed >= period) {
+  		    elapsed = (elapsed < 2 * period) ? (elapsed - period) : (elapsed % period);
+  		    *cycleStart = now - elapsed;
+  		  }
+  		  return elapsed;
+  		}
+
+  private:
+  		static int64_t	Extend(uint32_t time);
+
+  		static uint32_t	s_last;
+  		static uint16_t	s_wraps;
+};
+
+#endif // __searob_clock_h__
@@ -1,11 +1,31 @@
 #include "SeaRobDisplay.h"
 
+// The activity circle bouncing along the right half of the header.
+#define ACTIVITY_CIRCLE_RADIUS	5
+#define ACTIVITY_CIRCLE_Y		ACTIVITY_CIRCLE_RADIUS
+#define ACTIVITY_CIRCLE_LEFT	66
+#define ACTIVITY_CIRCLE_PERIOD	3000
+
+// Text size 1 glyphs, including the spacing column.
+#define FIELD_CHAR_WIDTH	6
+#define FIELD_CHAR_HEIGHT	8
+
 /**
  * Called at global static init time
  */
-SeaRobDisplay::SeaRobDisplay(int pinSda, int pinScl) : 
-  _display(pinSda, pinScl),
+SeaRobDisplay::SeaRobDisplay(int pinSda, int pinScl, Transport transport) : 
+  _bitBangTransport(pinSda, pinScl),
+  _twiTransport(),
+  _display((transport == Transport::HardwareTwi) ? 
+  	(ssd1306syp_Transport *) &_twiTransport : (ssd1306syp_Transport *) &_bitBangTransport),
   _timestamp(""),
+  _flushMaxBytes(DISPLAY_FLUSH_BYTES),
+  _flushMaxMicros(0),
+  _fieldCount(0),
+  _activityIndicator(false),
+  _activityX(-1),
+  _refreshMs(DISPLAY_REFRESH_MS),
+  _lastRender(0),
   _bluetoothSet(false),
   _bluetoothName("unknown"),
   _bluetoothAddr("unknown") {
@@ -36,6 +56,26 @@ void SeaRobDisplay::setupBluetoothName(
 }
 
 
+/**
+ * How much of the frame goes out per flush(); a zero limit is not applied. Both zero sends
+ * whole frames, blocking the loop for the entire transfer.
+ */
+void SeaRobDisplay::setFlushBudget(unsigned int maxBytes, unsigned long maxMicros) {
+  _flushMaxBytes = maxBytes;
+  _flushMaxMicros = maxMicros;
+}
+
+/**
+ * Sends the next slice of the frame in flight; once it is complete, snapshots the framebuffer
+ * as the next frame. Drawing can carry on meanwhile, it only shows up in the next frame.
+ */
+void SeaRobDisplay::flush() {
+  if (_display.isFrameComplete()) {
+    _display.beginUpdate();
+  }
+  _display.continueUpdate(_flushMaxBytes, _flushMaxMicros);
+}
+
 /**
  * Main output for status while in main sequence. This is called once per loop.
  */
@@ -58,17 +98,7 @@ void SeaRobDisplay::displayStandard(const char *header, const char *line1, const
   _display.setTextColor(WHITE);
 
   // Fun little animation to prove that we are not locked up.
-  const int circleRadius = 5;
-  const int circleOffset = 0;
-  const int maxRight = (SCREEN_WIDTH - 1) - circleRadius;
-  const int maxLeft = 66;
-  int numFrames = maxRight - maxLeft;
-  int numFramesDouble = numFrames * 2;
-  int timePerFrame = 3000 / numFramesDouble;
-  int currentFrame = (millis() / timePerFrame) % numFramesDouble;
-  int circleCenterY = circleRadius + circleOffset;
-  int circleCenterX = (currentFrame < numFrames) ? (maxRight - currentFrame) : (maxLeft + (currentFrame - numFrames));
-  _display.drawCircle(circleCenterX, circleCenterY, circleRadius, WHITE);
+  _display.drawCircle(activityCircleX(millis()), ACTIVITY_CIRCLE_Y, ACTIVITY_CIRCLE_RADIUS, WHITE);
   
   // Finish Header.
   _display.setCursor(0,1);
@@ -108,5 +138,137 @@ void SeaRobDisplay::displayStandard(const char *header, const char *line1, const
   //_display.setCursor(4, beginStamp + 2);
   //_display.println(_timestamp);
 
-  _display.update();
-}
\ No newline at end of file
+  flush();
+}
+/**
+ * Where the activity circle is centered at the given time.
+ */
+int SeaRobDisplay::activityCircleX(unsigned long updateTime) {
+  const int maxRight = (SCREEN_WIDTH - 1) - ACTIVITY_CIRCLE_RADIUS;
+  int numFrames = maxRight - ACTIVITY_CIRCLE_LEFT;
+  int numFramesDouble = numFrames * 2;
+  int timePerFrame = ACTIVITY_CIRCLE_PERIOD / numFramesDouble;
+  int currentFrame = (updateTime / timePerFrame) % numFramesDouble;
+  return (currentFrame < numFrames) ? (maxRight - currentFrame) : (ACTIVITY_CIRCLE_LEFT + (currentFrame - numFrames));
+}
+
+/**
+ * Registers a retained-mode text field; returns its id, or -1 when all fields are taken.
+ */
+int SeaRobDisplay::addField(int x, int y, int maxChars) {
+  if (_fieldCount >= DISPLAY_MAX_FIELDS) {
+    return -1;
+  }
+  if (maxChars > DISPLAY_FIELD_CHARS) {
+    maxChars = DISPLAY_FIELD_CHARS;
+  }
+  
+  Field *field = &_fields[_fieldCount];
+  field->x = x;
+  field->y = y;
+  field->maxChars = maxChars;
+  field->changed = false;
+  field->text[0] = 0;
+  return _fieldCount++;
+}
+
+/**
+ * The retained-mode version of displayStandard(): a header, a divider, four lines and the activity circle.
+ * Field ids follow StandardField.
+ */
+void SeaRobDisplay::setupStandardLayout() {
+  _fieldCount = 0;
+  addField(0, 1);
+  addField(0, 17);
+  addField(0, 27);
+  addField(0, 37);
+  addField(0, 47);
+  
+  _display.clear();
+  _display.setTextSize(1);
+  _display.setTextColor(WHITE);
+  _display.drawLine(0, 13, SCREEN_WIDTH - 1, 13, WHITE); // top line
+  _activityIndicator = true;
+  _activityX = -1;
+  _lastRender = millis() - _refreshMs;
+}
+
+/**
+ * Sets the text of a field; it is only redrawn if the text changed.
+ */
+void SeaRobDisplay::setField(int fieldId, const char *text) {
+  if ((fieldId < 0) || (fieldId >= _fieldCount)) {
+    return;
+  }
+  
+  Field *field = &_fields[fieldId];
+  if (!text) {
+    text = "";
+  }
+  if (strncmp(field->text, text, field->maxChars) == 0) {
+    return;
+  }
+  strncpy(field->text, text, field->maxChars);
+  field->text[field->maxChars] = 0;
+  field->changed = true;
+}
+
+/**
+ * printf flavor of setField().
+ */
+void SeaRobDisplay::setFieldf(int fieldId, const char *fmt, ...) {
+  char text[DISPLAY_FIELD_CHARS + 1];
+  va_list params;
+  va_start(params, fmt);
+  vsnprintf(text, sizeof(text), fmt, params);
+  va_end(params);
+  setField(fieldId, text);
+}
+
+/**
+ * Called once per loop in retained mode. Between refreshes it only keeps the current frame flowing
+ * out to the screen; on a refresh it redraws what changed, and the framebuffer's block tracking
+ * sends just those pixels.
+ */
+void SeaRobDisplay::render(unsigned long updateTime) {
+  if (!isRefreshDue(updateTime)) {
+    flush();
+    return;
+  }
+  _lastRender = updateTime;
+
+  // Has the circle moved? Erasing it can take bits of the fields underneath with it.
+  int circleX = _activityIndicator ? activityCircleX(updateTime) : -1;
+  boolean circleMoved = (circleX != _activityX);
+  if (circleMoved && (_activityX >= 0)) {
+    _display.drawCircle(_activityX, ACTIVITY_CIRCLE_Y, ACTIVITY_CIRCLE_RADIUS, BLACK);
+  }
+  
+  boolean circleCovered = false;
+  for (int i = 0 ; i < _fieldCount ; i++) {
+    Field *field = &_fields[i];
+    int width = field->maxChars * FIELD_CHAR_WIDTH;
+    boolean underCircle = (field->y < (ACTIVITY_CIRCLE_Y + ACTIVITY_CIRCLE_RADIUS + 1)) && 
+    	((field->y + FIELD_CHAR_HEIGHT) > (ACTIVITY_CIRCLE_Y - ACTIVITY_CIRCLE_RADIUS)) &&
+    	((field->x + width) > (ACTIVITY_CIRCLE_LEFT - ACTIVITY_CIRCLE_RADIUS));
+    if (circleMoved && underCircle) {
+      field->changed = true;
+    }
+    if (!field->changed) {
+      continue;
+    }
+    
+    _display.fillRect(field->x, field->y, width, FIELD_CHAR_HEIGHT, BLACK);
+    _display.setCursor(field->x, field->y);
+    _display.print(field->text);
+    field->changed = false;
+    circleCovered = circleCovered || underCircle;
+  }
+  
+  if (_activityIndicator && (circleMoved || circleCovered)) {
+    _display.drawCircle(circleX, ACTIVITY_CIRCLE_Y, ACTIVITY_CIRCLE_RADIUS, WHITE);
+  }
+  _activityX = circleX;
+  
+  flush();
+}
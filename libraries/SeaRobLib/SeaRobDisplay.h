@@ -8,11 +8,30 @@
 // Constants
 #define SCREEN_WIDTH 128 // OLED display width, in pixels
 #define SCREEN_HEIGHT 64 // OLED display height, in pixels
+#define DISPLAY_FLUSH_BYTES 128 // Default flush budget per loop, in framebuffer bytes (0 = whole frame)
+#define DISPLAY_MAX_FIELDS 8 // Text fields in retained mode
+#define DISPLAY_FIELD_CHARS 21 // Widest field: a full line of 6 pixel characters
+#define DISPLAY_REFRESH_MS 100 // Default minimum time between retained-mode renders
   
   
 class SeaRobDisplay {
   public:
-          SeaRobDisplay(int pinSda, int pinScl);
+  	typedef enum {
+  	  BitBang = 0,		// software i2c on any two pins.
+  	  HardwareTwi,		// the TWI peripheral at 400 kHz; pins are fixed (20/21 on the mega).
+  	} Transport;
+  	
+  	// Field ids registered by setupStandardLayout(), in the same places displayStandard() prints.
+  	typedef enum {
+  	  Header = 0,
+  	  Line1,
+  	  Line2,
+  	  Line3,
+  	  Line4,
+  	} StandardField;
+
+  public:
+          SeaRobDisplay(int pinSda, int pinScl, Transport transport = Transport::BitBang);
   
     void  	setup(
     		  const char *timestamp);
@@ -35,10 +54,50 @@ class SeaRobDisplay {
     		  
     boolean isBluetoothSet() { return _bluetoothSet; }
     
+    // Retained mode: fields are registered once and set by value; render() redraws only the
+    // fields whose text changed, at most once per refresh interval. Not to be mixed with the
+    // displayStandard() family, which redraws the whole screen.
+    int		addField(int x, int y, int maxChars = DISPLAY_FIELD_CHARS);
+    void	setupStandardLayout();
+    void	setField(int fieldId, const char *text);
+    void	setFieldf(int fieldId, const char *fmt, ...);
+    void	setRefreshInterval(unsigned long refreshMs) { _refreshMs = refreshMs; }
+    boolean	isRefreshDue(unsigned long updateTime) { return (updateTime - _lastRender) >= _refreshMs; }
+    void	render(unsigned long updateTime);
+    
+    // The frame is sent to the screen a slice at a time, spread over calls to flush().
+    void	setFlushBudget(unsigned int maxBytes, unsigned long maxMicros);
+    void	flush();
+    boolean	isFrameComplete() { return _display.isFrameComplete(); }
+    unsigned long getLastFrameLatency() { return _display.lastFrameMicros(); }
+    
   private:
+	int		activityCircleX(unsigned long updateTime);
+	
+	typedef struct {
+	  int			x;
+	  int			y;
+	  int			maxChars;
+	  boolean		changed;
+	  char			text[DISPLAY_FIELD_CHARS + 1];
+	} Field;
+
+  private:
+	ssd1306syp_BitBangTransport	_bitBangTransport;
+	ssd1306syp_TwiTransport		_twiTransport;
 	Adafruit_ssd1306syp _display;
 	const char *		_timestamp;
 	
+	unsigned int		_flushMaxBytes;
+	unsigned long		_flushMaxMicros;
+	
+	Field				_fields[DISPLAY_MAX_FIELDS];
+	int					_fieldCount;
+	boolean				_activityIndicator;
+	int					_activityX; // -1 when not drawn yet
+	unsigned long		_refreshMs;
+	unsigned long		_lastRender;
+	
 	boolean				_bluetoothSet;
 	const char *		_bluetoothName;
 	const char *		_bluetoothAddr;
@@ -0,0 +1,135 @@
+#include "Arduino.h"
+#include <Wire.h>
+#include "SeaRobExpander.h"
+#include "SeaRobLogger.h"
+
+// MCP23017 registers, IOCON.BANK = 0: the A and B registers of a pair are adjacent.
+#define MCP_IODIRA 		0x00
+#define MCP_GPIOA 		0x12
+#define MCP_OLATA 		0x14
+
+// IOCON: INTA and INTB mirrored, open drain; sequential addressing.
+#define MCP_IOCON_MIRROR 	0x40
+#define MCP_IOCON_ODR 		0x04
+
+
+/* static class objects (global) */
+uint8_t SeaRobExpander::s_present = 0;
+int8_t SeaRobExpander::s_intPin[EXPANDER_MAX_CHIPS];
+uint8_t SeaRobExpander::s_output[EXPANDER_MAX_CHIPS][2];
+uint8_t SeaRobExpander::s_pullUp[EXPANDER_MAX_CHIPS][2];
+
+
+/*
+ */
+bool SeaRobExpander::Begin(uint8_t chip, int intPin) {
+	if (chip >= EXPANDER_MAX_CHIPS) {
+		bclogger_error("SeaRobExpander: no chip %d, only %d", chip, EXPANDER_MAX_CHIPS);
+		return false;
+	}
+
+	Wire.begin();
+	Wire.setClock(EXPANDER_I2C_CLOCK);
+	s_intPin[chip] = intPin;
+	if (intPin >= 0) {
+		pinMode(intPin, INPUT_PULLUP);
+	}
+
+	uint8_t dark[2] = { 0, 0 };
+	s_present |= 1 << chip;
+	Write(chip, dark);
+	if (!Configure(chip)) {
+		s_present &= ~(1 << chip);
+		bclogger_error("SeaRobExpander: chip %d (0x%02x) does not answer", chip, EXPANDER_ADDRESS + chip);
+		return false;
+	}
+
+	bclogger("SeaRobExpander: chip %d (0x%02x), int=%d, pins %d-%d",
+		chip, EXPANDER_ADDRESS + chip, intPin, EXPANDER_PIN_BASE + 16 * chip, EXPANDER_PIN_BASE + 16 * chip + 15);
+	return true;
+}
+
+
+/*
+ * Every configuration register, IODIRA to GPPUB, in one sequential write.
+ */
+bool SeaRobExpander::Configure(uint8_t chip) {
+	Wire.beginTransmission(EXPANDER_ADDRESS + chip);
+	Wire.write(MCP_IODIRA);
+	for (uint8_t half = 0 ; half < 2 ; half++) {
+		Wire.write((uint8_t) ~s_output[chip][half]); // IODIR
+	}
+	Wire.write(0); // IPOL
+	Wire.write(0);
+	for (uint8_t half = 0 ; half < 2 ; half++) {
+		Wire.write((uint8_t) ~s_output[chip][half]); // GPINTEN: every input
+	}
+	Wire.write(0); // DEFVAL
+	Wire.write(0);
+	Wire.write(0); // INTCON: against the previous level
+	Wire.write(0);
+	Wire.write(MCP_IOCON_MIRROR | MCP_IOCON_ODR); // IOCON, at both addresses
+	Wire.write(MCP_IOCON_MIRROR | MCP_IOCON_ODR);
+	Wire.write(s_pullUp[chip][0]); // GPPU
+	Wire.write(s_pullUp[chip][1]);
+	return Wire.endTransmission() == 0;
+}
+
+
+/*
+ */
+void SeaRobExpander::PinMode(int pin, uint8_t mode) {
+	uint8_t chip = (pin - EXPANDER_PIN_BASE) / 16;
+	uint8_t half = ((pin - EXPANDER_PIN_BASE) / 8) & 1;
+	uint8_t mask = 1 << ((pin - EXPANDER_PIN_BASE) % 8);
+
+	s_output[chip][half] = (mode == OUTPUT) ? (s_output[chip][half] | mask) : (s_output[chip][half] & ~mask);
+	s_pullUp[chip][half] = (mode == INPUT_PULLUP) ? (s_pullUp[chip][half] | mask) : (s_pullUp[chip][half] & ~mask);
+	if (IsPresent(chip)) {
+		Configure(chip);
+	}
+}
+
+
+/*
+ * OLATA and OLATB; input pins ignore their latch bits.
+ */
+void SeaRobExpander::Write(uint8_t chip, const uint8_t *image) {
+	if (!IsPresent(chip)) {
+		return;
+	}
+	Wire.beginTransmission(EXPANDER_ADDRESS + chip);
+	Wire.write(MCP_OLATA);
+	Wire.write(image[0]);
+	Wire.write(image[1]);
+	Wire.endTransmission();
+}
+
+
+/*
+ * INT is active low, and stays asserted until GPIO is read.
+ */
+bool SeaRobExpander::IsQuiet(uint8_t chip) {
+	if (!IsPresent(chip)) {
+		return true;
+	}
+	return (s_intPin[chip] >= 0) && (digitalRead(s_intPin[chip]) == HIGH);
+}
+
+
+/*
+ * GPIOA and GPIOB, after a repeated start; reading them clears the interrupt.
+ */
+bool SeaRobExpander::Read(uint8_t chip, uint8_t *image) {
+	Wire.beginTransmission(EXPANDER_ADDRESS + chip);
+	Wire.write(MCP_GPIOA);
+	if (Wire.endTransmission(false) != 0) {
+		return false;
+	}
+	if (Wire.requestFrom((uint8_t) (EXPANDER_ADDRESS + chip), (uint8_t) 2) != 2) {
+		return false;
+	}
+	image[0] = Wire.read();
+	image[1] = Wire.read();
+	return true;
+}
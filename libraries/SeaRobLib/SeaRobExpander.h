@@ -0,0 +1,71 @@
+#ifndef __searob_expander_h__
+#define __searob_expander_h__
+
+#include "Arduino.h"
+#include "SeaRobShiftIn.h"
+
+// Virtual pins: EXPANDER_PIN_BASE + 16 * chip + pin, GPA0-GPA7 being 0-7 and GPB0-GPB7 8-15.
+// Chip n answers at EXPANDER_ADDRESS + n (its A2-A0 strapped to n), so eight fit on the bus.
+// After the SeaRobShiftIn pins.
+#ifndef EXPANDER_PIN_BASE
+#define EXPANDER_PIN_BASE 			(SHIFTIN_PIN_BASE + 8 * SHIFTIN_MAX_REGISTERS)
+#endif
+#ifndef EXPANDER_MAX_CHIPS
+#define EXPANDER_MAX_CHIPS 			8
+#endif
+#define EXPANDER_ADDRESS 			0x20
+
+// Fast mode; short runs only, the bus was not made for long cables.
+#ifndef EXPANDER_I2C_CLOCK
+#define EXPANDER_I2C_CLOCK 			400000L
+#endif
+
+
+/*
+ * I/O expansion through MCP23017 16-bit expanders on the I2C bus (SDA 20, SCL 21), for
+ * outputs and buttons out on a slab a short run away from the board.
+ *
+ * Each chip is two ports (GPIOA and GPIOB) of SeaRobOutput and two of SeaRobInput, so lights
+ * and buttons attach to its virtual pins like any other. Register access is batched: Commit()
+ * writes both output latches of a chip that changed in one transaction, and a scan reads both
+ * GPIO registers in another. With the chip's INT output wired to a board pin (INTA and INTB
+ * mirrored, open drain, so several chips may share one pin), a chip whose inputs have not
+ * changed is not read at all; one without is read on every scan. At 400kHz the write
+ * takes 95us and the read, with its repeated start, about 125us.
+ *
+ * Virtual pins cannot dim; a dimmable SeaRobLight on one is on/off. The simulator models the
+ * chip's registers behind its Wire (SeaRobSim::AttachMcp23017), bus time included.
+ */
+class SeaRobExpander {
+  public:
+  		// Starts Wire and sets up chip n, its outputs low. Pins not given a mode are inputs
+  		// without pull-up. intPin is the board pin its INT line is wired to, or -1. False if
+  		// the chip does not answer.
+  		static bool		Begin(uint8_t chip, int intPin = -1);
+
+  		static bool		IsVirtual(int pin) {
+  		  return (pin >= EXPANDER_PIN_BASE) && (pin < EXPANDER_PIN_BASE + 16 * EXPANDER_MAX_CHIPS);
+  		}
+  		static bool		IsPresent(uint8_t chip) { return (s_present >> chip) & 1; }
+
+  		// OUTPUT, INPUT or INPUT_PULLUP; inputs interrupt on change. Written to the chip at
+  		// once, or by Begin() when it comes later, as it does for objects built before setup().
+  		static void		PinMode(int pin, uint8_t mode);
+
+  		// Called by SeaRobOutput::Commit(), with the GPIOA and GPIOB images of one chip.
+  		static void		Write(uint8_t chip, const uint8_t *image);
+  		// Called by SeaRobInput::Scan(). Quiet when the chip is absent, or its INT line says
+  		// nothing changed since the last Read(); Read() returns false on a bus error.
+  		static bool		IsQuiet(uint8_t chip);
+  		static bool		Read(uint8_t chip, uint8_t *image);
+
+  private:
+  		static bool		Configure(uint8_t chip);
+
+  		static uint8_t	s_present; // a bit per chip that answered Begin()
+  		static int8_t	s_intPin[EXPANDER_MAX_CHIPS];
+  		static uint8_t	s_output[EXPANDER_MAX_CHIPS][2]; // IODIR, inverted
+  		static uint8_t	s_pullUp[EXPANDER_MAX_CHIPS][2]; // GPPU
+};
+
+#endif // __searob_expander_h__
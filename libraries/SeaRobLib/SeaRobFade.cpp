@@ -0,0 +1,105 @@
+#include "Arduino.h"
+#include "SeaRobFade.h"
+
+/*
+ * Brightness for fade progress 0-255; generated, see the formula above each table.
+ */
+
+// 255 * t^2.2
+static const uint8_t fadeGamma[256] PROGMEM = {
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,
+	  3,   3,   3,   3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,
+	  6,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  11,  11,  11,  12,
+	 12,  13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,
+	 20,  20,  21,  22,  22,  23,  23,  24,  25,  25,  26,  26,  27,  28,  28,  29,
+	 30,  30,  31,  32,  33,  33,  34,  35,  35,  36,  37,  38,  39,  39,  40,  41,
+	 42,  43,  43,  44,  45,  46,  47,  48,  49,  49,  50,  51,  52,  53,  54,  55,
+	 56,  57,  58,  59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,
+	 73,  74,  75,  76,  77,  78,  79,  81,  82,  83,  84,  85,  87,  88,  89,  90,
+	 91,  93,  94,  95,  97,  98,  99, 100, 102, 103, 105, 106, 107, 109, 110, 111,
+	113, 114, 116, 117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+	137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154, 156, 158, 159, 161,
+	163, 165, 166, 168, 170, 172, 173, 175, 177, 179, 181, 182, 184, 186, 188, 190,
+	192, 194, 196, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+	223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246, 248, 251, 253, 255,
+};
+
+// 255 * (1 - cos(pi * t)) / 2
+static const uint8_t fadeEaseInOut[256] PROGMEM = {
+	  0,   0,   0,   0,   0,   0,   0,   0,   1,   1,   1,   1,   1,   2,   2,   2,
+	  2,   3,   3,   3,   4,   4,   5,   5,   6,   6,   6,   7,   8,   8,   9,   9,
+	 10,  10,  11,  12,  12,  13,  14,  14,  15,  16,  17,  17,  18,  19,  20,  21,
+	 22,  23,  23,  24,  25,  26,  27,  28,  29,  30,  31,  32,  33,  34,  35,  37,
+	 38,  39,  40,  41,  42,  43,  45,  46,  47,  48,  49,  51,  52,  53,  54,  56,
+	 57,  58,  60,  61,  62,  64,  65,  66,  68,  69,  71,  72,  73,  75,  76,  78,
+	 79,  81,  82,  84,  85,  87,  88,  90,  91,  93,  94,  96,  97,  99, 100, 102,
+	103, 105, 106, 108, 109, 111, 113, 114, 116, 117, 119, 120, 122, 124, 125, 127,
+	128, 130, 131, 133, 135, 136, 138, 139, 141, 142, 144, 146, 147, 149, 150, 152,
+	153, 155, 156, 158, 159, 161, 162, 164, 165, 167, 168, 170, 171, 173, 174, 176,
+	177, 179, 180, 182, 183, 184, 186, 187, 189, 190, 191, 193, 194, 195, 197, 198,
+	199, 201, 202, 203, 204, 206, 207, 208, 209, 210, 212, 213, 214, 215, 216, 217,
+	218, 220, 221, 222, 223, 224, 225, 226, 227, 228, 229, 230, 231, 232, 232, 233,
+	234, 235, 236, 237, 238, 238, 239, 240, 241, 241, 242, 243, 243, 244, 245, 245,
+	246, 246, 247, 247, 248, 249, 249, 249, 250, 250, 251, 251, 252, 252, 252, 253,
+	253, 253, 253, 254, 254, 254, 254, 254, 255, 255, 255, 255, 255, 255, 255, 255,
+};
+
+// 255 * (2^(8t) - 1) / (2^8 - 1)
+static const uint8_t fadeExponential[256] PROGMEM = {
+	  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+	  0,   0,   0,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,
+	  1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,
+	  2,   2,   2,   2,   2,   2,   2,   2,   2,   2,   3,   3,   3,   3,   3,   3,
+	  3,   3,   3,   3,   3,   3,   4,   4,   4,   4,   4,   4,   4,   4,   4,   5,
+	  5,   5,   5,   5,   5,   5,   5,   6,   6,   6,   6,   6,   6,   7,   7,   7,
+	  7,   7,   7,   8,   8,   8,   8,   8,   9,   9,   9,   9,   9,  10,  10,  10,
+	 10,  11,  11,  11,  11,  12,  12,  12,  13,  13,  13,  14,  14,  14,  14,  15,
+	 15,  16,  16,  16,  17,  17,  17,  18,  18,  19,  19,  20,  20,  20,  21,  21,
+	 22,  22,  23,  23,  24,  25,  25,  26,  26,  27,  27,  28,  29,  29,  30,  31,
+	 31,  32,  33,  34,  34,  35,  36,  37,  38,  38,  39,  40,  41,  42,  43,  44,
+	 45,  46,  47,  48,  49,  50,  51,  52,  54,  55,  56,  57,  59,  60,  61,  63,
+	 64,  65,  67,  68,  70,  72,  73,  75,  76,  78,  80,  82,  83,  85,  87,  89,
+	 91,  93,  95,  97,  99, 102, 104, 106, 109, 111, 114, 116, 119, 121, 124, 127,
+	129, 132, 135, 138, 141, 144, 148, 151, 154, 158, 161, 165, 168, 172, 176, 180,
+	184, 188, 192, 196, 201, 205, 209, 214, 219, 224, 229, 234, 239, 244, 249, 255,
+};
+
+
+/*
+ */
+uint8_t SeaRobFade::Level(Curve curve, uint8_t progress) {
+	switch (curve) {
+	case Gamma:
+		return pgm_read_byte(&fadeGamma[progress]);
+	case EaseInOut:
+		return pgm_read_byte(&fadeEaseInOut[progress]);
+	case Exponential:
+		return pgm_read_byte(&fadeExponential[progress]);
+	case Linear:
+	default:
+		return progress;
+	}
+}
+
+
+/*
+ */
+unsigned long SeaRobFade::Rate(unsigned int fadeMillis) {
+	if (fadeMillis == 0) {
+		return FADE_RATE_ONE;
+	}
+	return FADE_RATE_ONE / fadeMillis;
+}
+
+
+/*
+ */
+uint8_t SeaRobFade::Progress(unsigned long rate, unsigned long elapsedMillis, unsigned int fadeMillis) {
+	// Checked first, so the product below stays under 2^24.
+	if (elapsedMillis >= fadeMillis) {
+		return 255;
+	}
+	unsigned long progress = (elapsedMillis * rate) >> 16;
+	return (progress > 255) ? 255 : (uint8_t) progress;
+}
@@ -0,0 +1,33 @@
+#ifndef __searob_fade_h__
+#define __searob_fade_h__
+
+#include "Arduino.h"
+
+// Progress is 8.16 fixed point: 256 << 16 is the whole fade.
+#define FADE_RATE_ONE 	(256UL << 16)
+
+
+/*
+ * Integer fade curves for dimmable lights. A fade works out its rate once, when it starts
+ * (the only division); after that each step is one multiply, a shift and a table lookup in
+ * flash, instead of the soft-float maths the AVR would otherwise do on every tick.
+ */
+class SeaRobFade {
+  public:
+  	typedef enum {
+  	  Linear = 0,
+  	  Gamma, // perceptually even steps for an LED
+  	  EaseInOut,
+  	  Exponential,
+  	} Curve;
+  	
+  public:
+  		// Fixed-point progress per milli, for Progress().
+  		static unsigned long	Rate(unsigned int fadeMillis);
+  		// 0-255 through a fade of fadeMillis, never past either end.
+  		static uint8_t			Progress(unsigned long rate, unsigned long elapsedMillis, unsigned int fadeMillis);
+  		// Brightness 0-255 for progress 0-255.
+  		static uint8_t			Level(Curve curve, uint8_t progress);
+};
+
+#endif // __searob_fade_h__
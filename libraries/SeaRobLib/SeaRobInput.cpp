@@ -0,0 +1,186 @@
+#include "Arduino.h"
+#include "SeaRobInput.h"
+#include "SeaRobLogger.h"
+
+
+/* static class objects (global) */
+SeaRobInput::Watch SeaRobInput::s_watches[INPUT_MAX_WATCHES];
+int SeaRobInput::s_watchCount = 0;
+uint8_t SeaRobInput::s_watched[INPUT_PORTS];
+uint8_t SeaRobInput::s_stable[INPUT_PORTS];
+uint8_t SeaRobInput::s_count0[INPUT_PORTS];
+uint8_t SeaRobInput::s_count1[INPUT_PORTS];
+bool SeaRobInput::s_chainWatched = false;
+uint8_t SeaRobInput::s_chain[SHIFTIN_MAX_REGISTERS];
+uint8_t SeaRobInput::s_expander[2 * EXPANDER_MAX_CHIPS];
+uint8_t SeaRobInput::s_expanderStale = 0;
+unsigned long SeaRobInput::s_lastSample = 0;
+
+
+/*
+ */
+int SeaRobInput::Attach(int pin, int level, onPinChange handler, void *opaque) {
+	int handle = 0;
+	while ((handle < s_watchCount) && (s_watches[handle].handler != NULL)) {
+		handle++;
+	}
+	if (handle == INPUT_MAX_WATCHES) {
+		bclogger_error("SeaRobInput: no room for pin %d", pin);
+		return -1;
+	}
+	if (handle == s_watchCount) {
+		s_watchCount++;
+	}
+
+	Watch *watch = &s_watches[handle];
+	if (SeaRobShiftIn::IsVirtual(pin)) {
+		watch->port = INPUT_CHAIN_PORT + (pin - SHIFTIN_PIN_BASE) / 8;
+		watch->mask = 1 << ((pin - SHIFTIN_PIN_BASE) % 8);
+		s_chainWatched = true;
+	} else if (SeaRobExpander::IsVirtual(pin)) {
+		// INT only tells of changes; the level it starts at has to be read once.
+		watch->port = INPUT_EXPANDER_PORT + (pin - EXPANDER_PIN_BASE) / 8;
+		watch->mask = 1 << ((pin - EXPANDER_PIN_BASE) % 8);
+		s_expanderStale |= 1 << ((pin - EXPANDER_PIN_BASE) / 16);
+	} else {
+#if defined(__AVR__)
+		watch->port = digitalPinToPort(pin);
+		watch->mask = digitalPinToBitMask(pin);
+#else
+		watch->port = pin;
+		watch->mask = 1;
+#endif
+	}
+	watch->opaque = opaque;
+	watch->handler = handler;
+
+	// Counters idle (both bits set) until the pin disagrees with its image.
+	uint8_t port = watch->port;
+	s_stable[port] = level ? (s_stable[port] | watch->mask) : (s_stable[port] & ~watch->mask);
+	s_count0[port] |= watch->mask;
+	s_count1[port] |= watch->mask;
+	s_watched[port] |= watch->mask;
+
+	bclogger("SeaRobInput: pin %d on port %d, mask=0x%02x", pin, port, watch->mask);
+	return handle;
+}
+
+
+/*
+ * The port stays scanned while another watch has the same bit.
+ */
+void SeaRobInput::Detach(int handle) {
+	if ((handle < 0) || (handle >= s_watchCount) || (s_watches[handle].handler == NULL)) {
+		return;
+	}
+
+	Watch *watch = &s_watches[handle];
+	watch->handler = NULL;
+
+	uint8_t watched = 0;
+	for (int i = 0 ; i < s_watchCount ; i++) {
+		if ((s_watches[i].handler != NULL) && (s_watches[i].port == watch->port)) {
+			watched |= s_watches[i].mask;
+		}
+	}
+	s_watched[watch->port] = watched;
+	
+	s_chainWatched = false;
+	for (uint8_t port = INPUT_CHAIN_PORT ; port < INPUT_EXPANDER_PORT ; port++) {
+		s_chainWatched |= (s_watched[port] != 0);
+	}
+}
+
+
+/*
+ */
+void SeaRobInput::PinMode(int pin, uint8_t mode) {
+	if (SeaRobExpander::IsVirtual(pin)) {
+		SeaRobExpander::PinMode(pin, mode);
+	} else if (!SeaRobShiftIn::IsVirtual(pin)) {
+		pinMode(pin, mode);
+	}
+}
+
+
+/*
+ */
+uint8_t SeaRobInput::ReadPort(uint8_t port) {
+	if (port >= INPUT_EXPANDER_PORT) {
+		return s_expander[port - INPUT_EXPANDER_PORT];
+	}
+	if (port >= INPUT_CHAIN_PORT) {
+		return s_chain[port - INPUT_CHAIN_PORT];
+	}
+#if defined(__AVR__)
+	return *portInputRegister(port);
+#else
+	return digitalRead(port) ? 1 : 0;
+#endif
+}
+
+
+/*
+ * Reading a chip clears its interrupt, long before a new level has been sampled often enough
+ * to count; so a chip stays read on every sample until its counters are back to idle.
+ */
+void SeaRobInput::LoadExpanders() {
+	for (uint8_t chip = 0 ; chip < EXPANDER_MAX_CHIPS ; chip++) {
+		uint8_t port = INPUT_EXPANDER_PORT + 2 * chip;
+		if (!(s_watched[port] | s_watched[port + 1]) || !SeaRobExpander::IsPresent(chip)) {
+			continue;
+		}
+
+		uint8_t running = (uint8_t) ~(s_count0[port] & s_count1[port]) & s_watched[port];
+		running |= (uint8_t) ~(s_count0[port + 1] & s_count1[port + 1]) & s_watched[port + 1];
+		if (!running && !((s_expanderStale >> chip) & 1) && SeaRobExpander::IsQuiet(chip)) {
+			continue;
+		}
+		if (SeaRobExpander::Read(chip, &s_expander[2 * chip])) {
+			s_expanderStale &= ~(1 << chip);
+		}
+	}
+}
+
+
+/*
+ */
+void SeaRobInput::Scan(unsigned long now) {
+	if ((uint32_t) (now - s_lastSample) < INPUT_SAMPLE_MILLIS) {
+		return;
+	}
+	s_lastSample = now;
+	if (s_chainWatched) {
+		SeaRobShiftIn::Load(s_chain);
+	}
+	LoadExpanders();
+
+	for (uint8_t port = 0 ; port < INPUT_PORTS ; port++) {
+		uint8_t watched = s_watched[port];
+		if (!watched) {
+			continue;
+		}
+
+		// A bit that agrees with the image resets its counter to idle (3); one that differs
+		// counts down, and is accepted when it wraps back round to 3, on the fourth sample.
+		uint8_t differ = (ReadPort(port) ^ s_stable[port]) & watched;
+		uint8_t count0 = ~(s_count0[port] & differ);
+		uint8_t count1 = count0 ^ (s_count1[port] & differ);
+		s_count0[port] = count0;
+		s_count1[port] = count1;
+
+		uint8_t changed = differ & count0 & count1;
+		if (!changed) {
+			continue;
+		}
+		uint8_t stable = s_stable[port] ^ changed;
+		s_stable[port] = stable;
+
+		for (int i = 0 ; i < s_watchCount ; i++) {
+			Watch *watch = &s_watches[i];
+			if ((watch->handler != NULL) && (watch->port == port) && (watch->mask & changed)) {
+				watch->handler(watch->opaque, (stable & watch->mask) ? HIGH : LOW, now);
+			}
+		}
+	}
+}
@@ -0,0 +1,89 @@
+#ifndef __searob_input_h__
+#define __searob_input_h__
+
+#include "Arduino.h"
+#include "SeaRobExpander.h"
+#include "SeaRobPinChange.h"
+#include "SeaRobShiftIn.h"
+
+// 6 bytes each on the Mega. CascadiaControlNeuveau watches 17 buttons; past the last watch a
+// SeaRobSpringButton polls its pin on its own.
+#ifndef INPUT_MAX_WATCHES
+#define INPUT_MAX_WATCHES 		20
+#endif
+
+// A level counts once four samples this far apart agree: 15-20ms of debounce.
+#define INPUT_SAMPLE_MILLIS 	5
+
+/*
+ * Ports as SeaRobOutput has them: the PINx registers, indexed by digitalPinToPort(), on the
+ * AVR; elsewhere (the simulator) every pin is its own one-bit port, read with digitalRead.
+ * The 74HC165 registers of SeaRobShiftIn follow, one port each, then GPIOA and GPIOB of each
+ * SeaRobExpander chip.
+ */
+#if defined(__AVR__)
+#define INPUT_MCU_PORTS 	13
+#else
+#define INPUT_MCU_PORTS 	NUM_DIGITAL_PINS
+#endif
+#define INPUT_CHAIN_PORT 		INPUT_MCU_PORTS
+#define INPUT_EXPANDER_PORT 	(INPUT_CHAIN_PORT + SHIFTIN_MAX_REGISTERS)
+#define INPUT_PORTS 			(INPUT_EXPANDER_PORT + 2 * EXPANDER_MAX_CHIPS)
+
+
+/*
+ * Polled digital inputs, a whole port at a time. Scan() reads each PINx register that has a
+ * watched pin once per sample, XORs it with the debounced image to find the bits that differ,
+ * and debounces all eight with a pair of vertical counters: two bytes of bit-sliced 2-bit
+ * counters, stepped for every bit in a handful of instructions. Only the pins whose level
+ * changed get their handler called, so a quiet pass costs the same however many buttons
+ * there are. A SeaRobShiftIn chain is read in one burst per sample, when a pin on it is
+ * watched, and debounced the same way. So is a SeaRobExpander chip, one transaction for both
+ * its ports, but only while its INT line is asserted or its counters are still running.
+ *
+ * The handler is the pin-change one (SeaRobPinChange.h), with the time the level was accepted.
+ * SeaRobScheduler::Service() runs the scan.
+ */
+class SeaRobInput {
+  public:
+  		// level is what the caller takes the pin to be at now; if it is not, the handler is
+  		// told once the pin has been steady long enough. Returns a handle for Detach(), or -1.
+  		static int		Attach(int pin, int level, onPinChange handler, void *opaque);
+  		static void		Detach(int handle);
+
+  		static void		Scan(unsigned long now);
+  		
+  		// On a shift register or an expander: only Scan() can read it.
+  		static bool		IsVirtual(int pin) {
+  		  return SeaRobShiftIn::IsVirtual(pin) || SeaRobExpander::IsVirtual(pin);
+  		}
+  		// pinMode() for any pin; the chain's pull-ups are resistors on the panel.
+  		static void		PinMode(int pin, uint8_t mode);
+
+  		static int		GetWatchCount() { return s_watchCount; }
+
+  private:
+  		typedef struct {
+  		  uint8_t				port;
+  		  uint8_t				mask;
+  		  onPinChange			handler; // NULL when the slot is free
+  		  void *				opaque;
+  		} Watch;
+
+  		static uint8_t	ReadPort(uint8_t port);
+  		static void		LoadExpanders();
+
+  		static Watch			s_watches[INPUT_MAX_WATCHES];
+  		static int				s_watchCount; // high-water mark; detached watches leave holes
+  		static uint8_t			s_watched[INPUT_PORTS]; // bits with a watch on them
+  		static uint8_t			s_stable[INPUT_PORTS]; // debounced levels
+  		static uint8_t			s_count0[INPUT_PORTS]; // vertical counters: low bits
+  		static uint8_t			s_count1[INPUT_PORTS]; // and high bits
+  		static bool				s_chainWatched;
+  		static uint8_t			s_chain[SHIFTIN_MAX_REGISTERS]; // as last loaded
+  		static uint8_t			s_expander[2 * EXPANDER_MAX_CHIPS]; // as last read
+  		static uint8_t			s_expanderStale; // a bit per chip to read whatever INT says
+  		static unsigned long	s_lastSample;
+};
+
+#endif // __searob_input_h__
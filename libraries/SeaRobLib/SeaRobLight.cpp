@@ -1,6 +1,8 @@
 #include "Arduino.h"
+#include "SeaRobClock.h"
 #include "SeaRobLight.h"
 #include "SeaRobLogger.h"
+#include "SeaRobScheduler.h"
 
 
 /*
@@ -10,40 +12,53 @@ SeaRobLight::SeaRobLight(int pin, int blinkOffset) : SeaRobLight(pin, false, bli
 
 /*
 */
-SeaRobLight::SeaRobLight(int pin, bool dimmable, int blinkOffset) : _pin(pin), _dimmable(dimmable) {
+SeaRobLight::SeaRobLight(int pin, bool dimmable, int blinkOffset) 
+		: _pin(pin), _dimmable(dimmable && (SeaRobPixels::IsVirtual(pin) || !SeaRobOutput::IsVirtual(pin))) {
   _state = LightState::Off;
   _lastToggleState = LightState::On;
   _fadeState = FadeState::FadeOff;
-  _fadeStart = 0;
   _fadeInTime = 0;
   _fadeOutTime = 0;
+  _fadeCurve = SeaRobFade::Linear;
+  _fadeTime = 0;
+  _fadeInRate = 0;
+  _fadeOutRate = 0;
   
   _blinkOffset = blinkOffset;
   _blinkDurationCount = 0;
-  _blinkDurationIndex = 0;
-  _blinkDurations = NULL;
+  _blinkStartOn = false;
+  _blinkWaiting = false;
+  _blinkPeriod = 0;
+  _blinkPhase = 0;
+  _blinkCycleStart = 0;
   _blinkTimeNext = 0;
   
   _dimLevel = 255;
   _litState = false;
+  _writtenValue = -1;
   _loggingState = false;
 
-  unsigned long now = millis();
-  if (_blinkOffset > 0) {
-    _blinkTimeNext = (now + _blinkOffset);
+  _softPwmChannel = -1;
+  if (_dimmable) {
+    if (!SeaRobPixels::IsVirtual(_pin)) {
+      pinMode(_pin, OUTPUT);
+      if (!digitalPinHasPWM(_pin)) {
+        _softPwmChannel = SeaRobSoftPwm::Attach(_pin);
+      }
+    }
+  } else {
+    _output = SeaRobOutput::Attach(_pin);
   }
-
-  pinMode(_pin, OUTPUT);
+  SeaRobScheduler::Wake(this);
  
-  bclogger("SeaRobLight [%d] pin=%d, dimmable=%d, dimLevel=%d, state=%d, offset=%d, nextblink=%lu, ", 
-    _objId, _pin, _dimmable, _dimLevel, _state, _blinkOffset, _blinkTimeNext);
+  bclogger("SeaRobLight [%d] pin=%d, dimmable=%d, dimLevel=%d, state=%d, offset=%d", 
+    _objId, _pin, _dimmable, _dimLevel, _state, _blinkOffset);
 }
 
 
 /*
  */
 SeaRobLight::~SeaRobLight() {
-	delete[] _blinkDurations;
 }
 
 /*
@@ -60,7 +75,11 @@ void SeaRobLight::SetDebugLogging(bool setter) {
 /*
  */
 void SeaRobLight::UpdateState(LightState state) {
+   if ((state == LightState::UniformBlink) && (_state != LightState::UniformBlink)) {
+      ResumeBlink();
+   }
    _state = state;
+   SeaRobScheduler::Wake(this);
 
    if (_loggingState) {
       bclogger("SeaRobLight::UpdateState: [%d] pin=%d, state=%d", _objId, _pin, _state);
@@ -71,6 +90,7 @@ void SeaRobLight::UpdateState(LightState state) {
  */
 void SeaRobLight::UpdateDimLevel(int dimLevel) {
    _dimLevel = dimLevel;
+   SeaRobScheduler::Wake(this);
 
    if (_loggingState) {
       bclogger("SeaRobLight::UpdateDimLevel: [%d] pin=%d, state=%d, level=%d", _objId, _pin, _state, _dimLevel);
@@ -90,23 +110,30 @@ void SeaRobLight::UpdateBlinkConfig(unsigned long startTime, int offset, int dur
  */
 void SeaRobLight::UpdateBlinkSequenceConfig(unsigned long startTime, int offset, int durationCount, int *durations, 
 				boolean startOn, int fadeInDelay, int fadeOutDelay) {
+	int fallbackDuration = 1000;
 			
 	// Set initial state.
 	_blinkOffset = offset;
-	_blinkTimeNext = startTime + _blinkOffset;
+	_blinkStartOn = startOn;
 	_litState = startOn;
 	_fadeInTime = fadeInDelay;
 	_fadeOutTime = fadeOutDelay;
+	_fadeInRate = SeaRobFade::Rate(_fadeInTime);
+	_fadeOutRate = SeaRobFade::Rate(_fadeOutTime);
 	
-	// Setup the blink state, deleting any previous state.
-	if (_blinkDurations) {
-		delete[] _blinkDurations;
-		_blinkDurations = NULL;
+	// Setup the blink state, replacing any previous state.
+	if (durationCount > LIGHT_MAX_DURATIONS) {
+		bclogger_error("SeaRobLight::UpdateBlinkConfig [%d] pin=%d: %d durations, only %d kept", 
+			_objId, _pin, durationCount, LIGHT_MAX_DURATIONS);
+		durationCount = LIGHT_MAX_DURATIONS;
+	}
+	if (durationCount <= 0) {
+		bclogger_error("SeaRobLight::UpdateBlinkConfig [%d] pin=%d: no durations, blinking at 1000", 
+			_objId, _pin);
+		durationCount = 1;
+		durations = &fallbackDuration;
 	}
-	
 	_blinkDurationCount = durationCount;
-	_blinkDurationIndex = 0;
-	_blinkDurations = new int[durationCount];
 	for (int i = 0 ; i < _blinkDurationCount ; i++) {
 		_blinkDurations[i] = durations[i];
 		if (_loggingState) {
@@ -115,18 +142,58 @@ void SeaRobLight::UpdateBlinkSequenceConfig(unsigned long startTime, int offset,
 		}
 	}
 	
+	// A cycle is every duration, each after the fade into it; an odd count takes two rounds
+	// to come back to the same lit state.
+	_blinkPeriod = 0;
+	int slots = (_blinkDurationCount & 1) ? (2 * _blinkDurationCount) : _blinkDurationCount;
+	bool lit = _blinkStartOn;
+	for (int slot = 0 ; slot < slots ; slot++) {
+		lit = !lit;
+		_blinkPeriod += FadeInto(lit) + _blinkDurations[slot % _blinkDurationCount];
+	}
+	AnchorBlink(startTime + _blinkOffset);
+	SeaRobScheduler::Wake(this);
+	
 	if (_loggingState) {
-		bclogger("SeaRobLight::UpdateBlinkConfig [%d] pin=%d, state=%d, durations=%d, offset=%d, startTime=%lu, nextblink=%lu", 
-			_objId, _pin, _state, _blinkDurationCount, _blinkOffset, startTime, _blinkTimeNext);
+		bclogger("SeaRobLight::UpdateBlinkConfig [%d] pin=%d, state=%d, durations=%d, offset=%d, startTime=%lu, period=%lu", 
+			_objId, _pin, _state, _blinkDurationCount, _blinkOffset, startTime, (unsigned long) _blinkPeriod);
 	}
 }
 
 
+/*
+ * Pins the cycle to the clock: it starts at anchor, or started there, a whole number of
+ * periods ago.
+ */
+void SeaRobLight::AnchorBlink(unsigned long anchor) {
+	_blinkPhase = SeaRobClock::Phase(anchor, _blinkPeriod);
+	_blinkCycleStart = anchor;
+	_blinkWaiting = true;
+	ResumeBlink();
+}
+
+
+/*
+ * Back into the cycle wherever the clock has got to, after time spent on or off.
+ */
+void SeaRobLight::ResumeBlink() {
+	uint32_t now = millis();
+	if (_blinkWaiting && ((int32_t) (now - _blinkCycleStart) < 0)) {
+		return;
+	}
+	_blinkWaiting = false;
+	_blinkCycleStart = SeaRobClock::CycleStart(now, _blinkPhase, _blinkPeriod);
+}
+
+
 /*
  */
 void SeaRobLight::ToggleOnOff() {
    switch (_state) {
     case LightState::Off:
+      if (_lastToggleState == LightState::UniformBlink) {
+        ResumeBlink();
+      }
       _state = _lastToggleState;
       _litState = true;
       break;
@@ -147,6 +214,7 @@ void SeaRobLight::ToggleOnOff() {
       _litState = false;
       break;
    }
+   SeaRobScheduler::Wake(this);
 
    if (_loggingState) {
       bclogger("SeaRobLight::ToggleOnOff [%d] pin=%d, state=%d, litState=%d, dimLevel=%d", 
@@ -161,6 +229,25 @@ boolean SeaRobLight::IsOn() {
   return _litState;
 }
 
+/*
+ * Steady at this level at once, for a caller that animates the light itself; an on/off light
+ * is lit from 128 up.
+ */
+void SeaRobLight::ShowLevel(uint8_t level) {
+  _fadeState = FadeState::FadeOff;
+  if (_dimmable) {
+    _state = LightState::On;
+    _litState = true;
+    _dimLevel = level;
+    WritePin(level);
+  } else {
+    _litState = (level >= 128);
+    _state = _litState ? LightState::On : LightState::Off;
+    WritePin(_litState ? HIGH : LOW);
+  }
+  SeaRobScheduler::Cancel(this);
+}
+
 /* 
  */
 int SeaRobLight::GetDimLevel() {
@@ -169,21 +256,21 @@ int SeaRobLight::GetDimLevel() {
 
 /*
  */
-String SeaRobLight::GetStateName() {
+const __FlashStringHelper * SeaRobLight::GetStateName() {
   switch (_state) {
     case LightState::Off:
-      return "off";
+      return F("off");
       
     case LightState::On: 
-     return "on";
+     return F("on");
 
     case LightState::UniformBlink:
-      return "blink";
+      return F("blink");
     
     default:
-      bclogger("SeaRobLight::GetStateName [%d] pin=%d, ILLEGAL STATE CHANGE", 
+      bclogger_error("SeaRobLight::GetStateName [%d] pin=%d, ILLEGAL STATE CHANGE", 
       	_objId, _pin);
-      return "illegal-state";
+      return F("illegal-state");
    }
 }
 
@@ -196,6 +283,47 @@ void SeaRobLight::ProcessLoop(unsigned long updateTime) {
   } else {
   	ProcessLoopNonDimmable(updateTime);
   }
+  ScheduleNext(updateTime);
+}
+
+
+/*
+ * Steady lights need no more calls until something changes them; a fade steps about once per
+ * dim level.
+ */
+void SeaRobLight::ScheduleNext(unsigned long updateTime) {
+  if (_state != LightState::UniformBlink) {
+    SeaRobScheduler::Cancel(this);
+    return;
+  }
+  
+  unsigned long next = _blinkTimeNext;
+  if (_dimmable && (_fadeState != FadeState::FadeOff)) {
+    unsigned long step = (_fadeTime > 256) ? (_fadeTime >> 8) : 1;
+    if ((int32_t) (next - (updateTime + step)) > 0) {
+      next = updateTime + step;
+    }
+  }
+  SeaRobScheduler::ScheduleAt(this, next);
+}
+
+
+/*
+ */
+void SeaRobLight::WritePin(int value) {
+  if (value == _writtenValue) {
+    return;
+  }
+  _writtenValue = value;
+  if (_softPwmChannel >= 0) {
+    SeaRobSoftPwm::Set(_softPwmChannel, value);
+  } else if (!_dimmable) {
+    SeaRobOutput::Write(_output, value);
+  } else if (SeaRobPixels::IsVirtual(_pin)) {
+    SeaRobOutput::WriteLevel(_pin, value);
+  } else {
+    analogWrite(_pin, value);
+  }
 }
 
 #define DELAY_TIME 1000
@@ -214,67 +342,15 @@ void SeaRobLight::ProcessLoopDimmable(unsigned long updateTime) {
 		break;
     
     case LightState::UniformBlink:
-    	switch (_fadeState) {
-    		case FadeState::FadeOff: {
-				if (updateTime >= _blinkTimeNext) {		
-					_fadeState = _litState ? FadeState::FadeOut : FadeState::FadeIn;
-					_fadeStart = _blinkTimeNext;
-					_blinkTimeNext = _blinkTimeNext + ((_fadeState == FadeState::FadeOut) ? _fadeOutTime : _fadeInTime);
-				}
-			}
-			break;
-				
-			case FadeState::FadeOut: {
-				// calculate current dim level
-				unsigned long millisDone = updateTime - _fadeStart;
-				float partDone = (float) millisDone / (float) _fadeOutTime;
-				int level = 256 - (int) (partDone * 256);
-				_dimLevel = level;
-				if (_loggingState) {
-					bclogger("SeaRobLight:ProcessLoopDimmable [%d] fadeout part=%0.1f dimlevel = %d", 
-						_objId, partDone, _dimLevel);
-				}
-				
-				if (updateTime >= _blinkTimeNext) {	
-					if (_loggingState) {
-						bclogger("SeaRobLight:ProcessLoopDimmable [%d] fadeout complete", _objId);
-					}
-					_fadeState = FadeState::FadeOff;
-					_litState = false;
-					RescheduleBlink();
-				}
-			}
-			break;
-					
-			case FadeState::FadeIn: {
-				// calculate current dim level
-				unsigned long millisDone = updateTime - _fadeStart;
-				float partDone = (float) millisDone / (float) _fadeInTime;
-				int level = (int) (partDone * 256);
-				_dimLevel = level;
-				_litState = true;
-				if (_loggingState) {
-					bclogger("SeaRobLight:ProcessLoopDimmable [%d] fadein part=%0.1f dimlevel = %d", 
-						_objId, partDone, _dimLevel);
-				}
-				
-				if (updateTime >= _blinkTimeNext) {	
-					if (_loggingState) {
-						bclogger("SeaRobLight:ProcessLoopDimmable [%d] fadein complete", _objId);
-					}
-					_fadeState = FadeState::FadeOff;
-					RescheduleBlink();
-				}
-			}
-			break;
-	 }
+		EvaluateBlink(updateTime);
+		break;
   }
 
   // Write out current state to the led.
   int writeValue = _litState ? _dimLevel : 0;
   if (writeValue < 0) writeValue = 0;
   if (writeValue > 255) writeValue = 255;
-  analogWrite(_pin, writeValue);
+  WritePin(writeValue);
 }
 
 /*
@@ -290,48 +366,67 @@ void SeaRobLight::ProcessLoopNonDimmable(unsigned long updateTime) {
 		break;
     
     case LightState::UniformBlink:
-		if (updateTime >= _blinkTimeNext) {
-			_litState = !_litState;
-			RescheduleBlink();
-		}
+		EvaluateBlink(updateTime);
       	break;
   }
 
   // Write out current state to the led.
-  digitalWrite(_pin, _litState);
+  WritePin(_litState ? HIGH : LOW);
 }
 
 
 /*
-*/
-void SeaRobLight::RescheduleBlink() {
-	unsigned long thisTime = _blinkTimeNext;
-
-	int nextDuration = 1000;
-	if (!_blinkDurations) {
-		bclogger("SeaRobLight:RescheduleBlink [%d] pin=%d, state=%d, ILLEGAL STATE - no durations", 
+ * Where the cycle is at updateTime: lit or not, the level of a fade under way, and when the
+ * next edge (or end of the fade) is due. Each duration is a slot that starts by toggling the
+ * light, fading into the new state first when dimmable.
+ */
+void SeaRobLight::EvaluateBlink(unsigned long updateTime) {
+	_fadeState = FadeState::FadeOff;
+	if (_blinkWaiting) {
+		if ((int32_t) (updateTime - _blinkCycleStart) < 0) {
+			_litState = _blinkStartOn;
+			_blinkTimeNext = _blinkCycleStart;
+			return;
+		}
+		_blinkWaiting = false;
+	}
+	if (_blinkPeriod == 0) {
+		bclogger_error("SeaRobLight:EvaluateBlink [%d] pin=%d, state=%d, ILLEGAL STATE - no durations", 
 			_objId, _pin, _state);
-	} else {
-		nextDuration = _blinkDurations[_blinkDurationIndex];
-		if (_loggingState) {
-			bclogger("SeaRobLight:RescheduleBlink [%d] duration index %d = %d", 
-				_objId, _blinkDurationIndex, nextDuration);
+		_blinkTimeNext = updateTime + 1000;
+		return;
+	}
+	
+	uint32_t into = SeaRobClock::Elapsed(updateTime, &_blinkCycleStart, _blinkPeriod);
+	bool lit = _blinkStartOn;
+	for (int slot = 0 ; ; slot++) {
+		lit = !lit;
+		unsigned int fade = FadeInto(lit);
+		uint32_t length = fade + _blinkDurations[slot % _blinkDurationCount];
+		if (into >= length) {
+			into -= length;
+			continue;
 		}
-
-		_blinkDurationIndex++;
-		if (_blinkDurationIndex >= _blinkDurationCount)
-			_blinkDurationIndex = 0;
-			
+		
+		if (into < fade) {
+			_fadeState = lit ? FadeState::FadeIn : FadeState::FadeOut;
+			_fadeTime = fade;
+			uint8_t progress = SeaRobFade::Progress(lit ? _fadeInRate : _fadeOutRate, into, fade);
+			_dimLevel = SeaRobFade::Level(_fadeCurve, lit ? progress : 255 - progress);
+			_litState = true;
+			_blinkTimeNext = updateTime + (fade - into);
+		} else {
+			if (fade > 0) {
+				_dimLevel = SeaRobFade::Level(_fadeCurve, lit ? 255 : 0);
+			}
+			_litState = lit;
+			_blinkTimeNext = updateTime + (length - into);
+		}
+		
 		if (_loggingState) {
-			bclogger("SeaRobLight:RescheduleBlink [%d] next index is %d", 
-				_objId, _blinkDurationIndex);
+			bclogger("SeaRobLight:EvaluateBlink [%d] pin=%d, slot=%d, lit=%d, fade=%d, dimLevel=%d, next=%lu", 
+				_objId, _pin, slot, lit, _fadeState, _dimLevel, _blinkTimeNext);
 		}
-	}
-
-	_blinkTimeNext = _blinkTimeNext + nextDuration;
-	
-	if (_loggingState) {
-		bclogger("SeaRobLight:RescheduleBlink [%d] pin=%d, state=%d, nextDur=%d, thisFrameStart=%lu, nextFrameStart=%lu", 
-			_objId, _pin, _state, nextDuration, thisTime, _blinkTimeNext);
+		return;
 	}
 }
@@ -1,11 +1,23 @@
 #ifndef __searob_light_h__
 #define __searob_light_h__
 
+#include "SeaRobFade.h"
 #include "SeaRobObject.h"
+#include "SeaRobOutput.h"
+#include "SeaRobSoftPwm.h"
+
+#define LIGHT_MAX_DURATIONS 	4
 
 /*
  * Represents one led that can be either on or off. One output pin is required per light. 
  *  It can be set to blink overtime, or just stay in its current state until set again.
+ *  A steady light is left alone by the scheduler; a blinking one wakes at its next edge,
+ *  and the pin is only written when its level changes. Blinks keep SeaRobClock time: the
+ *  state at each edge comes from where the light is in its cycle, so it never drifts or
+ *  has to catch up, and lights anchored at the same time blink together. On/off lights go out through
+ *  SeaRobOutput, so nothing reaches the pin until the sketch commits. A dimmable light on
+ *  a pin without hardware PWM dims through SeaRobSoftPwm; one on a SeaRobPixels segment
+ *  sets the segment's level.
  */
 class SeaRobLight : public SeaRobObject {
 
@@ -36,18 +48,26 @@ class SeaRobLight : public SeaRobObject {
   		void		UpdateBlinkSequenceConfig(unsigned long startTime, int offset, int durationCount, int *durations, 
   						boolean startOn = false, int fadeInDelay = 0, int fadeOutDelay = 0);
   		
+  		void		SetFadeCurve(SeaRobFade::Curve curve) { _fadeCurve = curve; }
+  		
   		void		ToggleOnOff();
+  		void		ShowLevel(uint8_t level);
       	void    	SetDebugLogging(bool setter);
   					
   		bool		IsOn();
-  		String		GetStateName();
+  		const __FlashStringHelper *	GetStateName();
   					
   		virtual void	ProcessLoop(unsigned long updateTime);
   		
   protected:
   		virtual void	ProcessLoopDimmable(unsigned long updateTime);
   		virtual void	ProcessLoopNonDimmable(unsigned long updateTime);
-  		virtual void	RescheduleBlink();
+  		virtual void	EvaluateBlink(unsigned long updateTime);
+  		void			AnchorBlink(unsigned long anchor);
+  		void			ResumeBlink();
+  		void			ScheduleNext(unsigned long updateTime);
+  		void			WritePin(int value);
+  		unsigned int	FadeInto(bool lit) { return _dimmable ? (lit ? _fadeInTime : _fadeOutTime) : 0; }
   							
   private:
 	  const int        	_pin;
@@ -56,19 +76,29 @@ class SeaRobLight : public SeaRobObject {
 	  LightState       	_state;
 	  LightState       	_lastToggleState;
 	  FadeState			_fadeState;
-	  unsigned long    	_fadeStart;
 	  int				_fadeInTime;
 	  int				_fadeOutTime;
+	  SeaRobFade::Curve	_fadeCurve;
+	  unsigned int		_fadeTime; // of the fade in progress
+	  unsigned long		_fadeInRate; // see SeaRobFade::Rate()
+	  unsigned long		_fadeOutRate;
 	  
 	  int              	_blinkOffset;
 	  int				_blinkDurationCount;
-	  int				_blinkDurationIndex;
-	  int *				_blinkDurations;
-	  unsigned long    	_blinkTimeNext;
+	  int				_blinkDurations[LIGHT_MAX_DURATIONS];
+	  bool				_blinkStartOn;
+	  bool				_blinkWaiting; // for its anchor, still in the future
+	  uint32_t			_blinkPeriod; // a whole cycle, fades included; 0 until configured
+	  uint32_t			_blinkPhase; // see SeaRobClock
+	  uint32_t			_blinkCycleStart; // or the anchor, while waiting
+	  unsigned long    	_blinkTimeNext; // next edge, or fade step
 	  
 	  int				_dimLevel; // (0-255)
 	  
 	  bool             	_litState;
+	  int				_writtenValue; // last value sent to the pin, or -1
+	  SeaRobOutputPin	_output; // staged through SeaRobOutput unless dimmable
+	  int				_softPwmChannel; // or -1 for analogWrite
       bool             	_loggingState;
 };
 
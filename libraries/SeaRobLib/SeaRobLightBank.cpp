@@ -0,0 +1,395 @@
+#include "Arduino.h"
+#include "SeaRobClock.h"
+#include "SeaRobLightBank.h"
+#include "SeaRobLogger.h"
+#include "SeaRobScheduler.h"
+
+
+/* static class object (global) */
+SeaRobLightBank * SeaRobLightBank::s_default = NULL;
+
+
+/*
+ */
+SeaRobLightBank::SeaRobLightBank() : _count(0) {
+	for (int i = 0 ; i < LIGHTBANK_MAX_LIGHTS ; i++) {
+		_flags[i] = 0;
+	}
+	bclogger("SeaRobLightBank [%d] capacity=%d", _objId, LIGHTBANK_MAX_LIGHTS);
+}
+
+
+/*
+ */
+SeaRobLightBank * SeaRobLightBank::GetDefault() {
+	if (!s_default) {
+		s_default = new SeaRobLightBank();
+	}
+	return s_default;
+}
+
+
+/*
+ */
+int SeaRobLightBank::Add(int pin, int blinkOffset) {
+	int light = 0;
+	while ((light < _count) && (_flags[light] & LIGHTBANK_USED)) {
+		light++;
+	}
+	if (light == LIGHTBANK_MAX_LIGHTS) {
+		return -1;
+	}
+	if (light == _count) {
+		_count++;
+	}
+	
+	_pin[light] = pin;
+	_output[light] = SeaRobOutput::Attach(pin);
+	_flags[light] = LIGHTBANK_USED;
+	_state[light] = SeaRobLight::LightState::Off;
+	_lastToggleState[light] = SeaRobLight::LightState::On;
+	_next[light] = blinkOffset;
+	_phase[light] = 0;
+	_cycleStart[light] = blinkOffset;
+	_durationCount[light] = 0;
+	
+	bclogger("SeaRobLightBank [%d] light %d on pin=%d, offset=%d", _objId, light, pin, blinkOffset);
+	return light;
+}
+
+
+/*
+ */
+void SeaRobLightBank::Remove(int light) {
+	SeaRobOutput::Write(_output[light], LOW);
+	_flags[light] = 0;
+}
+
+
+/*
+ */
+void SeaRobLightBank::UpdateState(int light, SeaRobLight::LightState state) {
+	if ((state == SeaRobLight::LightState::UniformBlink) && (_state[light] != SeaRobLight::LightState::UniformBlink)) {
+		ResumeBlink(light);
+	}
+	_state[light] = state;
+	SeaRobScheduler::Wake(this);
+}
+
+
+/*
+ */
+void SeaRobLightBank::UpdateBlinkSequenceConfig(int light, unsigned long startTime, int offset, 
+		int durationCount, int *durations, boolean startOn) {
+	int fallbackDuration = 1000;
+	if (durationCount > LIGHTBANK_MAX_DURATIONS) {
+		bclogger_error("SeaRobLightBank [%d] light %d: %d durations, only %d kept", 
+			_objId, light, durationCount, LIGHTBANK_MAX_DURATIONS);
+		durationCount = LIGHTBANK_MAX_DURATIONS;
+	}
+	if (durationCount <= 0) {
+		bclogger_error("SeaRobLightBank [%d] light %d: no durations, blinking at 1000", _objId, light);
+		durationCount = 1;
+		durations = &fallbackDuration;
+	}
+	
+	_flags[light] = startOn ? (_flags[light] | LIGHTBANK_LIT | LIGHTBANK_START_ON) : 
+		(_flags[light] & ~(LIGHTBANK_LIT | LIGHTBANK_START_ON));
+	_durationCount[light] = durationCount;
+	for (int i = 0 ; i < durationCount ; i++) {
+		_durations[light][i] = durations[i];
+	}
+	
+	// Pinned to the clock: the cycle starts at the anchor, or started there a whole number of
+	// periods ago.
+	unsigned long anchor = startTime + offset;
+	_phase[light] = SeaRobClock::Phase(anchor, GetPeriod(light));
+	_cycleStart[light] = anchor;
+	_flags[light] |= LIGHTBANK_WAITING;
+	ResumeBlink(light);
+	SeaRobScheduler::Wake(this);
+}
+
+
+/*
+ * Back into the cycle wherever the clock has got to, after time spent on or off.
+ */
+void SeaRobLightBank::ResumeBlink(int light) {
+	uint32_t now = millis();
+	if ((_flags[light] & LIGHTBANK_WAITING) && ((int32_t) (now - _cycleStart[light]) < 0)) {
+		_next[light] = _cycleStart[light];
+		return;
+	}
+	_flags[light] &= ~LIGHTBANK_WAITING;
+	_cycleStart[light] = SeaRobClock::CycleStart(now, _phase[light], GetPeriod(light));
+	_next[light] = now;
+}
+
+
+/*
+ * Every duration; an odd count takes two rounds to come back to the same lit state.
+ */
+uint32_t SeaRobLightBank::GetPeriod(int light) {
+	uint32_t period = 0;
+	for (uint8_t i = 0 ; i < _durationCount[light] ; i++) {
+		period += _durations[light][i];
+	}
+	return (_durationCount[light] & 1) ? (2 * period) : period;
+}
+
+
+/*
+ */
+void SeaRobLightBank::ToggleOnOff(int light) {
+	if (_state[light] == SeaRobLight::LightState::Off) {
+		if (_lastToggleState[light] == SeaRobLight::LightState::UniformBlink) {
+			ResumeBlink(light);
+		}
+		_state[light] = _lastToggleState[light];
+		_flags[light] |= LIGHTBANK_LIT;
+	} else {
+		_lastToggleState[light] = _state[light];
+		_state[light] = SeaRobLight::LightState::Off;
+		_flags[light] &= ~LIGHTBANK_LIT;
+	}
+	SeaRobScheduler::Wake(this);
+}
+
+
+/*
+ */
+const __FlashStringHelper * SeaRobLightBank::GetStateName(int light) {
+	switch (_state[light]) {
+	case SeaRobLight::LightState::Off:
+		return F("off");
+	case SeaRobLight::LightState::On:
+		return F("on");
+	case SeaRobLight::LightState::UniformBlink:
+		return F("blink");
+	default:
+		return F("illegal-state");
+	}
+}
+
+
+/*
+ */
+void SeaRobLightBank::ProcessLoop(unsigned long updateTime) {
+	bool blinking = false;
+	unsigned long earliest = 0;
+	
+	for (uint8_t light = 0 ; light < _count ; light++) {
+		uint8_t flags = _flags[light];
+		if (!(flags & LIGHTBANK_USED)) {
+			continue;
+		}
+		
+		switch (_state[light]) {
+		case SeaRobLight::LightState::Off:
+			flags &= ~LIGHTBANK_LIT;
+			break;
+			
+		case SeaRobLight::LightState::On:
+			flags |= LIGHTBANK_LIT;
+			break;
+			
+		case SeaRobLight::LightState::UniformBlink:
+			if ((int32_t) (updateTime - _next[light]) >= 0) {
+				EvaluateBlink(light, updateTime);
+				flags = _flags[light];
+			}
+			if (!blinking || ((int32_t) (_next[light] - earliest) < 0)) {
+				earliest = _next[light];
+				blinking = true;
+			}
+			break;
+		}
+		
+		_flags[light] = flags;
+		SeaRobOutput::Write(_output[light], (flags & LIGHTBANK_LIT) ? HIGH : LOW);
+	}
+	
+	if (blinking) {
+		SeaRobScheduler::ScheduleAt(this, earliest);
+	} else {
+		SeaRobScheduler::Cancel(this);
+	}
+}
+
+
+/*
+ * Lit or not, and the next edge, from where the light is in its cycle at updateTime. Each
+ * duration starts by toggling the light.
+ */
+void SeaRobLightBank::EvaluateBlink(int light, unsigned long updateTime) {
+	uint8_t flags = _flags[light];
+	if (flags & LIGHTBANK_WAITING) {
+		if ((int32_t) (updateTime - _cycleStart[light]) < 0) {
+			_next[light] = _cycleStart[light];
+			return;
+		}
+		flags &= ~LIGHTBANK_WAITING;
+	}
+	
+	uint8_t count = _durationCount[light];
+	if (count == 0) {
+		bclogger_error("SeaRobLightBank [%d] light %d pin=%d, ILLEGAL STATE - no durations", 
+			_objId, light, _pin[light]);
+		_next[light] = updateTime + 1000;
+		return;
+	}
+	
+	uint32_t into = SeaRobClock::Elapsed(updateTime, &_cycleStart[light], GetPeriod(light));
+	bool lit = (flags & LIGHTBANK_START_ON) != 0;
+	for (uint8_t slot = 0 ; ; slot++) {
+		lit = !lit;
+		uint16_t length = _durations[light][(slot < count) ? slot : (slot - count)];
+		if (into < length) {
+			_next[light] = updateTime + (length - into);
+			break;
+		}
+		into -= length;
+	}
+	_flags[light] = lit ? (flags | LIGHTBANK_LIT) : (flags & ~LIGHTBANK_LIT);
+}
+
+
+/*
+ */
+void SeaRobLightHandle::Attach(int pin, bool dimmable, int blinkOffset) {
+	Release();
+	if (!dimmable) {
+		SeaRobLightBank *bank = SeaRobLightBank::GetDefault();
+		int index = bank->Add(pin, blinkOffset);
+		if (index >= 0) {
+			_bank = bank;
+			_index = index;
+			return;
+		}
+	}
+	_light = new SeaRobLight(pin, dimmable, blinkOffset);
+}
+
+
+/*
+ */
+void SeaRobLightHandle::Release() {
+	if (_bank) {
+		_bank->Remove(_index);
+		_bank = NULL;
+	}
+	delete _light;
+	_light = NULL;
+}
+
+
+/*
+ */
+void SeaRobLightHandle::UpdateState(SeaRobLight::LightState state) {
+	if (_bank) {
+		_bank->UpdateState(_index, state);
+	} else if (_light) {
+		_light->UpdateState(state);
+	}
+}
+
+
+/*
+ */
+void SeaRobLightHandle::UpdateDimLevel(int dimLevel) {
+	if (_light) {
+		_light->UpdateDimLevel(dimLevel);
+	}
+}
+
+
+/*
+ */
+void SeaRobLightHandle::UpdateBlinkConfig(unsigned long startTime, int offset, int durationOn, int durationOff, 
+		boolean startOn, int fadeInDelay, int fadeOutDelay) {
+	int durations[2] = { durationOn, durationOff };
+	UpdateBlinkSequenceConfig(startTime, offset, 2, durations, startOn, fadeInDelay, fadeOutDelay);
+}
+
+
+/*
+ */
+void SeaRobLightHandle::UpdateBlinkSequenceConfig(unsigned long startTime, int offset, int durationCount, int *durations, 
+		boolean startOn, int fadeInDelay, int fadeOutDelay) {
+	if (_bank) {
+		_bank->UpdateBlinkSequenceConfig(_index, startTime, offset, durationCount, durations, startOn);
+	} else if (_light) {
+		_light->UpdateBlinkSequenceConfig(startTime, offset, durationCount, durations, startOn, fadeInDelay, fadeOutDelay);
+	}
+}
+
+
+/*
+ */
+void SeaRobLightHandle::SetFadeCurve(SeaRobFade::Curve curve) {
+	if (_light) {
+		_light->SetFadeCurve(curve);
+	}
+}
+
+
+/*
+ */
+void SeaRobLightHandle::ToggleOnOff() {
+	if (_bank) {
+		_bank->ToggleOnOff(_index);
+	} else if (_light) {
+		_light->ToggleOnOff();
+	}
+}
+
+
+/*
+ */
+void SeaRobLightHandle::Show(bool lit) {
+	if (_bank) {
+		_bank->Show(_index, lit);
+	} else if (_light) {
+		_light->UpdateState(lit ? SeaRobLight::LightState::On : SeaRobLight::LightState::Off);
+	}
+}
+
+
+/*
+ */
+void SeaRobLightHandle::ShowLevel(uint8_t level) {
+	if (_bank) {
+		_bank->Show(_index, level >= 128);
+	} else if (_light) {
+		_light->ShowLevel(level);
+	}
+}
+
+
+/*
+ */
+void SeaRobLightHandle::SetDebugLogging(bool setter) {
+	if (_light) {
+		_light->SetDebugLogging(setter);
+	}
+}
+
+
+/*
+ */
+bool SeaRobLightHandle::IsOn() {
+	if (_bank) {
+		return _bank->IsOn(_index);
+	}
+	return _light ? _light->IsOn() : false;
+}
+
+
+/*
+ */
+const __FlashStringHelper * SeaRobLightHandle::GetStateName() {
+	if (_bank) {
+		return _bank->GetStateName(_index);
+	}
+	return _light ? _light->GetStateName() : F("none");
+}
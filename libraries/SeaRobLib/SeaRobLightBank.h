@@ -0,0 +1,118 @@
+#ifndef __searob_lightbank_h__
+#define __searob_lightbank_h__
+
+#include "SeaRobLight.h"
+#include "SeaRobObject.h"
+#include "SeaRobOutput.h"
+
+// 28 bytes a slot, used or not; a light that finds the bank full becomes a SeaRobLight
+// object instead (80-odd bytes), so this only has to cover the usual case. The sketches
+// put up to 9 lights in the default bank.
+#ifndef LIGHTBANK_MAX_LIGHTS
+#define LIGHTBANK_MAX_LIGHTS 		12
+#endif
+#define LIGHTBANK_MAX_DURATIONS 	LIGHT_MAX_DURATIONS
+
+// Bits of _flags.
+#define LIGHTBANK_USED 				0x01
+#define LIGHTBANK_LIT 				0x02
+#define LIGHTBANK_START_ON 			0x04
+#define LIGHTBANK_WAITING 			0x08 // for the blink anchor, still in the future
+
+
+/*
+ * On/off lights kept as parallel arrays instead of one SeaRobLight object each: about 30 bytes
+ * a light instead of 80-odd, with no heap, vtable or object header per light. The bank is one
+ * object to the scheduler, woken for the earliest blink edge of all its lights, and then runs
+ * them all in one non-virtual loop. Blinks keep SeaRobClock time, as SeaRobLight's do.
+ *
+ * Dimmable lights stay SeaRobLight objects; SeaRobLightHandle hides which kind a light is.
+ */
+class SeaRobLightBank : public SeaRobObject {
+  public:
+  					SeaRobLightBank();
+  					
+  		// The bank the button lights share; created on first use.
+  		static SeaRobLightBank *	GetDefault();
+  		// Slots the default bank has used so far, without creating it.
+  		static int					GetDefaultCount() { return s_default ? s_default->_count : 0; }
+  		
+  		// Returns the light's index, or -1 when full.
+  		int			Add(int pin, int blinkOffset = 0);
+  		void		Remove(int light);
+  		
+  		void		UpdateState(int light, SeaRobLight::LightState state);
+  		void		UpdateBlinkSequenceConfig(int light, unsigned long startTime, int offset, 
+  						int durationCount, int *durations, boolean startOn = false);
+  		void		ToggleOnOff(int light);
+  		
+  		// Steady on or off, written straight to the output: for a caller that animates the
+  		// light itself, frame by frame.
+  		void		Show(int light, bool lit) {
+  		  _state[light] = lit ? SeaRobLight::LightState::On : SeaRobLight::LightState::Off;
+  		  _flags[light] = lit ? (_flags[light] | LIGHTBANK_LIT) : (_flags[light] & ~LIGHTBANK_LIT);
+  		  SeaRobOutput::Write(_output[light], lit ? HIGH : LOW);
+  		}
+  		
+  		bool		IsOn(int light) { return (_flags[light] & LIGHTBANK_LIT) != 0; }
+  		SeaRobLight::LightState	GetState(int light) { return (SeaRobLight::LightState) _state[light]; }
+  		const __FlashStringHelper *	GetStateName(int light);
+  		
+  		virtual void	ProcessLoop(unsigned long updateTime);
+  		
+  private:
+  		void		EvaluateBlink(int light, unsigned long updateTime);
+  		void		ResumeBlink(int light);
+  		uint32_t	GetPeriod(int light);
+  		
+  		uint8_t				_count; // high-water mark; removed lights leave holes
+  		uint16_t			_pin[LIGHTBANK_MAX_LIGHTS]; // virtual pins run past 255
+  		SeaRobOutputPin		_output[LIGHTBANK_MAX_LIGHTS];
+  		uint8_t				_flags[LIGHTBANK_MAX_LIGHTS];
+  		uint8_t				_state[LIGHTBANK_MAX_LIGHTS];
+  		uint8_t				_lastToggleState[LIGHTBANK_MAX_LIGHTS];
+  		unsigned long		_next[LIGHTBANK_MAX_LIGHTS]; // next blink edge
+  		uint32_t			_phase[LIGHTBANK_MAX_LIGHTS]; // see SeaRobClock
+  		uint32_t			_cycleStart[LIGHTBANK_MAX_LIGHTS]; // or the anchor, while waiting
+  		uint8_t				_durationCount[LIGHTBANK_MAX_LIGHTS];
+  		uint16_t			_durations[LIGHTBANK_MAX_LIGHTS][LIGHTBANK_MAX_DURATIONS];
+  		
+  		static SeaRobLightBank *	s_default;
+};
+
+
+/*
+ * One light, wherever it lives: a slot in the default SeaRobLightBank for on/off lights, or a
+ * SeaRobLight for dimmable ones (and for on/off ones once the bank is full). Takes the same
+ * calls as SeaRobLight; the fade settings only mean something to dimmable lights.
+ */
+class SeaRobLightHandle {
+  public:
+  					SeaRobLightHandle() : _light(NULL), _bank(NULL), _index(0) {}
+  					
+  		void		Attach(int pin, bool dimmable, int blinkOffset = 0);
+  		void		Release();
+  		bool		IsValid() { return (_light != NULL) || (_bank != NULL); }
+  		
+  		void		UpdateState(SeaRobLight::LightState state);
+  		void		UpdateDimLevel(int dimLevel);
+  		void		UpdateBlinkConfig(unsigned long startTime, int offset, int durationOn, int durationOff, 
+  						boolean startOn = false, int fadeInDelay = 0, int fadeOutDelay = 0);
+  		void		UpdateBlinkSequenceConfig(unsigned long startTime, int offset, int durationCount, int *durations, 
+  						boolean startOn = false, int fadeInDelay = 0, int fadeOutDelay = 0);
+  		void		SetFadeCurve(SeaRobFade::Curve curve);
+  		void		ToggleOnOff();
+  		void		Show(bool lit);
+  		void		ShowLevel(uint8_t level); // on/off lights are lit from 128 up
+  		void		SetDebugLogging(bool setter);
+  		
+  		bool		IsOn();
+  		const __FlashStringHelper *	GetStateName();
+  		
+  private:
+  		SeaRobLight *		_light;
+  		SeaRobLightBank *	_bank;
+  		uint8_t				_index;
+};
+
+#endif // __searob_lightbank_h__
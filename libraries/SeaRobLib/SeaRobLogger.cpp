@@ -2,21 +2,302 @@
 #include "SeaRobLogger.h"
 
 /*
- * Global log buffer.
+ * Global log buffer; one line or binary record is built here before it is queued.
  */
-#define LOGBUF_SIZE 500
+#define LOGBUF_SIZE 160
 char logbuf[LOGBUF_SIZE + 1];
 
+/*
+ * Ring of formatted lines waiting for the UART; the size must be a power of two.
+ */
+#define LOGRING_SIZE 512
+#define LOGRING_MASK (LOGRING_SIZE - 1)
+static char logring[LOGRING_SIZE];
+static unsigned int logringHead = 0; // next byte to write
+static unsigned int logringTail = 0; // next byte to send
+
+static bool logAsync = false;
+static unsigned long logDropped = 0;
+static unsigned long logDroppedReported = 0;
+
+
+/*
+ */
+static unsigned int bclogger_used() {
+	return (logringHead - logringTail) & LOGRING_MASK;
+}
+
+
+/*
+ * Hands the UART as much of the ring as it takes without waiting.
+ */
+static void bclogger_flush() {
+	int room = Serial.availableForWrite();
+	while ((room > 0) && (logringTail != logringHead)) {
+		unsigned int chunk = (logringHead > logringTail) ? (logringHead - logringTail) : (LOGRING_SIZE - logringTail);
+		if (chunk > (unsigned int) room) {
+			chunk = room;
+		}
+		Serial.write((const uint8_t *) &logring[logringTail], chunk);
+		logringTail = (logringTail + chunk) & LOGRING_MASK;
+		room -= chunk;
+	}
+}
+
+
+/*
+ * Queues one record, plus a line ending for text; all or nothing. Without mayDrop it waits
+ * for room, only flushing: data may be logbuf, which the dropped-lines notice would reuse.
+ */
+static bool bclogger_enqueue(const char *data, unsigned int len, bool lineEnd, bool mayDrop) {
+	if (len > LOGRING_SIZE - 3) {
+		len = LOGRING_SIZE - 3;
+	}
+
+	unsigned int needed = lineEnd ? (len + 2) : len;
+	while ((LOGRING_SIZE - 1 - bclogger_used()) < needed) {
+		if (mayDrop) {
+			return false;
+		}
+		bclogger_flush();
+	}
+
+	for (unsigned int i = 0 ; i < len ; i++) {
+		logring[logringHead] = data[i];
+		logringHead = (logringHead + 1) & LOGRING_MASK;
+	}
+	if (lineEnd) {
+		logring[logringHead] = '\r';
+		logringHead = (logringHead + 1) & LOGRING_MASK;
+		logring[logringHead] = '\n';
+		logringHead = (logringHead + 1) & LOGRING_MASK;
+	}
+	return true;
+}
+
+
+/*
+ * Appends value as size little-endian bytes; false if the record is full.
+ */
+static bool bclogger_put(unsigned int *len, unsigned long value, unsigned int size) {
+	if (*len + size > LOGBUF_SIZE) {
+		return false;
+	}
+	for (unsigned int i = 0 ; i < size ; i++) {
+		logbuf[(*len)++] = (char) (value & 0xFF);
+		value >>= 8;
+	}
+	return true;
+}
+
+
+/*
+ * Appends a length byte and the characters, clipped to what is left in the record.
+ */
+static bool bclogger_putString(unsigned int *len, const char *str, bool inFlash) {
+	if (*len + 1 > LOGBUF_SIZE) {
+		return false;
+	}
+	unsigned int strLen = str ? (inFlash ? strlen_P(str) : strlen(str)) : 0;
+	unsigned int room = LOGBUF_SIZE - *len - 1;
+	if (strLen > room) {
+		strLen = room;
+	}
+	if (strLen > 0xFF) {
+		strLen = 0xFF;
+	}
+	logbuf[(*len)++] = (char) strLen;
+	if (inFlash) {
+		memcpy_P(&logbuf[*len], str, strLen);
+	} else {
+		memcpy(&logbuf[*len], str, strLen);
+	}
+	*len += strLen;
+	return true;
+}
+
+
+/*
+ * Builds a binary record in logbuf from the raw arguments; the format is only walked to
+ * learn their types. An argument that does not fit ends the payload early.
+ */
+static unsigned int bclogger_encode(uint16_t formatId, const char *fmt_P, va_list params) {
+	unsigned int len = 0;
+	bclogger_put(&len, BCLOG_SYNC, 1);
+	bclogger_put(&len, 0, 1); // payload length, filled in below
+	bclogger_put(&len, formatId, 2);
+	bclogger_put(&len, millis(), 4);
+
+	bool full = false;
+	for (const char *p = fmt_P ; !full ; p++) {
+		char c = pgm_read_byte(p);
+		if (c == 0) {
+			break;
+		}
+		if (c != '%') {
+			continue;
+		}
+
+		// Flags, width and precision; only a '*' takes an argument.
+		bool isLong = false;
+		c = pgm_read_byte(++p);
+		while ((c != 0) && (strchr("-+ #0123456789.*lh", c) != NULL)) {
+			if (c == 'l') {
+				isLong = true;
+			} else if (c == '*') {
+				full = !bclogger_put(&len, va_arg(params, int), 2);
+			}
+			c = pgm_read_byte(++p);
+		}
+
+		switch (c) {
+		case 0:
+			p--;
+			break;
+		case 'd':
+		case 'i':
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'o':
+		case 'c':
+			if (isLong) {
+				full = !bclogger_put(&len, va_arg(params, unsigned long), 4);
+			} else {
+				full = !bclogger_put(&len, va_arg(params, unsigned int), 2);
+			}
+			break;
+		case 'f':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G': {
+			float f = (float) va_arg(params, double);
+			uint32_t bits;
+			memcpy(&bits, &f, sizeof(bits));
+			full = !bclogger_put(&len, bits, 4);
+			break;
+		}
+		case 's':
+			full = !bclogger_putString(&len, va_arg(params, const char *), false);
+			break;
+		case 'S':
+			full = !bclogger_putString(&len, va_arg(params, const char *), true);
+			break;
+		case '%':
+			break;
+		default:
+			// Unknown conversion; the size of what follows cannot be known.
+			full = true;
+			break;
+		}
+	}
+
+	logbuf[1] = (char) (len - BCLOG_HEADER_SIZE);
+	return len;
+}
+
+
+/*
+ */
+void bclogger_setup(unsigned long baud) {
+	Serial.begin(baud);
+}
+
 
 /*
  * Global logger; currently outputs to the Serial Monitor.
  */
-void bclogger(const char* fmt, ...) {
+void bclogger_write_P(int level, const char* fmt_P, ...) {
+    va_list params;
+    va_start(params, fmt_P);
+
+    int len = vsnprintf_P(logbuf, LOGBUF_SIZE, fmt_P, params);
+    if (len < 0) {
+    	len = 0;
+    } else if (len > LOGBUF_SIZE - 1) {
+    	len = LOGBUF_SIZE - 1;
+    }
+    // Errors are worth the stall.
+    if (!bclogger_enqueue(logbuf, len, true, logAsync && (level < SEAROB_LOG_LEVEL_ERROR))) {
+    	logDropped++;
+    }
+
+    va_end(params);
+}
+
+
+/*
+ * Binary flavour of bclogger_write_P(); see SEAROB_LOG_BINARY.
+ */
+void bclogger_writeBinary_P(int level, uint16_t formatId, const char* fmt_P, ...) {
     va_list params;
-    va_start(params, fmt);
+    va_start(params, fmt_P);
 
-    vsnprintf(logbuf, LOGBUF_SIZE, fmt, params);
-    Serial.println(logbuf);
+    unsigned int len = bclogger_encode(formatId, fmt_P, params);
+    if (!bclogger_enqueue(logbuf, len, false, logAsync && (level < SEAROB_LOG_LEVEL_ERROR))) {
+    	logDropped++;
+    }
 
     va_end(params);
 }
+
+
+/*
+ * The dropped-lines notice, in whichever form the rest of the stream is; the decoder knows
+ * this format without finding it in the sources.
+ */
+#define BCLOG_DROPPED_FORMAT "bclogger: dropped %lu lines"
+
+static bool bclogger_writeNotice_P(uint16_t formatId, const char *fmt_P, ...) {
+	va_list params;
+	va_start(params, fmt_P);
+
+#if SEAROB_LOG_BINARY
+	unsigned int len = bclogger_encode(formatId, fmt_P, params);
+	bool queued = bclogger_enqueue(logbuf, len, false, true);
+#else
+	(void) formatId;
+	int len = vsnprintf_P(logbuf, LOGBUF_SIZE, fmt_P, params);
+	if (len < 0) {
+		len = 0;
+	} else if (len > LOGBUF_SIZE - 1) {
+		len = LOGBUF_SIZE - 1;
+	}
+	bool queued = bclogger_enqueue(logbuf, len, true, true);
+#endif
+
+	va_end(params);
+	return queued;
+}
+
+
+/*
+ * Call once per loop(); never waits on the UART.
+ */
+void bclogger_drain() {
+	if (logDropped != logDroppedReported) {
+		if (bclogger_writeNotice_P(BCLOG_ID(BCLOG_DROPPED_FORMAT), PSTR(BCLOG_DROPPED_FORMAT), 
+				logDropped - logDroppedReported)) {
+			logDroppedReported = logDropped;
+		}
+	}
+
+	bclogger_flush();
+}
+
+
+/*
+ */
+bool bclogger_setAsync(bool async) {
+	bool wasAsync = logAsync;
+	logAsync = async;
+	return wasAsync;
+}
+
+
+/*
+ */
+unsigned long bclogger_getDropped() {
+	return logDropped;
+}
@@ -1,8 +1,95 @@
 #ifndef __searob_logger_h__
 #define __searob_logger_h__
 
+#include "Arduino.h"
+
 /*
+ * Log levels. Calls below SEAROB_LOG_LEVEL are compiled away entirely; change the default
+ * here (the Arduino IDE has no per-sketch defines) to bring the debug chatter back.
  */
-void bclogger(const char* fmt, ...);
+#define SEAROB_LOG_LEVEL_DEBUG	0
+#define SEAROB_LOG_LEVEL_INFO	1
+#define SEAROB_LOG_LEVEL_ERROR	2
+#define SEAROB_LOG_LEVEL_NONE	3
+
+#ifndef SEAROB_LOG_LEVEL
+#define SEAROB_LOG_LEVEL		SEAROB_LOG_LEVEL_INFO
+#endif
+
+#ifndef SEAROB_LOG_BAUD
+#define SEAROB_LOG_BAUD			9600
+#endif
+
+/*
+ * Set SEAROB_LOG_BINARY to 1 to send each line as a compact binary record instead of text:
+ *   0xA5, payload length, format id (2 bytes), millis (4 bytes), payload
+ * all little-endian. The format id is a hash of the format literal, so the MCU never runs
+ * printf; the payload is the raw arguments in format order: %d/%u/%x/%c as 2 bytes, with 'l'
+ * as 4, %f as a 4-byte float, and %s/%S as a length byte plus the characters.
+ * libraries/SeaRobLib/extras/bclog_decode.py scans the sources for the formats and turns the
+ * stream back into text.
+ */
+#ifndef SEAROB_LOG_BINARY
+#define SEAROB_LOG_BINARY		0
+#endif
+
+#define BCLOG_SYNC				0xA5
+#define BCLOG_HEADER_SIZE		8
+
+/*
+ * Log lines are formatted into a ring buffer and trickled out to the Serial Monitor by
+ * bclogger_drain(), only as many bytes as the UART can take without blocking. Until
+ * bclogger_setAsync(true) a full ring is drained in place instead, so nothing from setup()
+ * is lost; after it, a line that does not fit is dropped and counted.
+ *
+ * Format strings always live in flash (PROGMEM); call through the macros below.
+ */
+void bclogger_setup(unsigned long baud = SEAROB_LOG_BAUD);
+void bclogger_write_P(int level, const char* fmt_P, ...);
+void bclogger_writeBinary_P(int level, uint16_t formatId, const char* fmt_P, ...);
+void bclogger_drain();
+// Returns the previous mode.
+bool bclogger_setAsync(bool async);
+unsigned long bclogger_getDropped();
+
+/*
+ * FNV-1a of the format literal, folded to 16 bits; the template forces it to be worked
+ * out by the compiler.
+ */
+constexpr uint32_t bclog_fnv(const char *s, uint32_t hash) {
+	return *s ? bclog_fnv(s + 1, (hash ^ (uint8_t) *s) * 16777619UL) : hash;
+}
+constexpr uint16_t bclog_fold(uint32_t hash) {
+	return (uint16_t) (hash ^ (hash >> 16));
+}
+template <uint16_t formatId>
+struct bclog_id {
+	static const uint16_t value = formatId;
+};
+#define BCLOG_ID(fmt)			(bclog_id<bclog_fold(bclog_fnv(fmt, 2166136261UL))>::value)
+
+#if SEAROB_LOG_BINARY
+#define BCLOG_WRITE(level, fmt, ...)	bclogger_writeBinary_P(level, BCLOG_ID(fmt), PSTR(fmt), ##__VA_ARGS__)
+#else
+#define BCLOG_WRITE(level, fmt, ...)	bclogger_write_P(level, PSTR(fmt), ##__VA_ARGS__)
+#endif
+
+#if SEAROB_LOG_LEVEL <= SEAROB_LOG_LEVEL_DEBUG
+#define bclogger_debug(...)		BCLOG_WRITE(SEAROB_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define bclogger_debug(...)		do {} while (0)
+#endif
+
+#if SEAROB_LOG_LEVEL <= SEAROB_LOG_LEVEL_INFO
+#define bclogger(...)			BCLOG_WRITE(SEAROB_LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define bclogger(...)			do {} while (0)
+#endif
+
+#if SEAROB_LOG_LEVEL <= SEAROB_LOG_LEVEL_ERROR
+#define bclogger_error(...)		BCLOG_WRITE(SEAROB_LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define bclogger_error(...)		do {} while (0)
+#endif
 
 #endif // __searob_logger_h__
@@ -1,5 +1,6 @@
 #include "Arduino.h"
 #include "SeaRobObject.h"
+#include "SeaRobScheduler.h"
 #include "SeaRobLogger.h"
 
 
@@ -9,7 +10,7 @@ int SeaRobObject::s_nextId = 0;
 
 /*
  */
-SeaRobObject::SeaRobObject(): _objId(++s_nextId), _creationTime(millis()) {
+SeaRobObject::SeaRobObject(): _scheduledTime(0), _timerSlot(-1), _objId(++s_nextId), _creationTime(millis()) {
   bclogger("SeaRobObject [%d]: ctor: creation=%lu", _objId, _creationTime);
 }
 
@@ -17,6 +18,8 @@ SeaRobObject::SeaRobObject(): _objId(++s_nextId), _creationTime(millis()) {
 /*
  */
 SeaRobObject::~SeaRobObject() {
+	SeaRobScheduler::Remove(this);
+	
 	unsigned long now = millis();
 	bclogger("SeaRobObject [%d]: dtor: creation=%lu, deletion=%lu, lifetime=%lu", 
 		_objId, _creationTime, now, (now - _creationTime));
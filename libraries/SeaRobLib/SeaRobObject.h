@@ -1,19 +1,30 @@
 #ifndef __searob_object_h__
 #define __searob_object_h__
 
+#include "SeaRobArena.h"
+
 /*
  * Abstract class for any object with a lifestime that needs to to be updated/polled to 
- * move the state machine forward.
+ * move the state machine forward. ProcessLoop() is called by SeaRobScheduler when the object
+ * has asked for it; see SeaRobScheduler.h. Objects are allocated from SeaRobArena.
  */
 class SeaRobObject {
 	public:
   						SeaRobObject();
   				virtual ~SeaRobObject();
+  				
+  		static void *	operator new(size_t size) { return SeaRobArena::Allocate(size); }
+  		static void		operator delete(void *block) { SeaRobArena::Release(block); }
   					
   		virtual void	ProcessLoop(unsigned long updateTime) = 0;
   			
 	private:
   		static int				s_nextId;
+  		
+  		// Owned by SeaRobScheduler.
+  		friend class SeaRobScheduler;
+  		unsigned long			_scheduledTime;
+  		int						_timerSlot; // index in the scheduler's heap, or -1
   						
 	protected:
 		const int        		_objId;
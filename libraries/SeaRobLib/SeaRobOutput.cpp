@@ -0,0 +1,125 @@
+#include "Arduino.h"
+#include "SeaRobOutput.h"
+#include "SeaRobSoftPwm.h"
+
+
+/* static class objects (global) */
+uint8_t SeaRobOutput::s_shadow[OUTPUT_PORTS];
+uint8_t SeaRobOutput::s_owned[OUTPUT_PORTS];
+bool SeaRobOutput::s_dirty[OUTPUT_PORTS];
+bool SeaRobOutput::s_anyDirty = false;
+onOutputLevel SeaRobOutput::s_levelHook = NULL;
+onOutputCommit SeaRobOutput::s_levelCommit = NULL;
+
+
+/*
+ */
+SeaRobOutputPin SeaRobOutput::Attach(int pin) {
+	SeaRobOutputPin out;
+	if (IsVirtual(pin)) {
+		if (SeaRobShiftOut::IsVirtual(pin)) {
+			out.port = OUTPUT_CHAIN_PORT + (pin - SHIFTOUT_PIN_BASE) / 8;
+			out.mask = 1 << ((pin - SHIFTOUT_PIN_BASE) % 8);
+		} else if (SeaRobExpander::IsVirtual(pin)) {
+			out.port = OUTPUT_EXPANDER_PORT + (pin - EXPANDER_PIN_BASE) / 8;
+			out.mask = 1 << ((pin - EXPANDER_PIN_BASE) % 8);
+			SeaRobExpander::PinMode(pin, OUTPUT);
+		} else {
+			out.port = OUTPUT_PIXELS_PORT + (pin - PIXELS_PIN_BASE) / 8;
+			out.mask = 1 << ((pin - PIXELS_PIN_BASE) % 8);
+		}
+		s_owned[out.port] |= out.mask;
+		s_shadow[out.port] &= ~out.mask;
+		s_dirty[out.port] = true;
+		s_anyDirty = true;
+		return out;
+	}
+	
+#if defined(__AVR__)
+	out.port = digitalPinToPort(pin);
+	out.mask = digitalPinToBitMask(pin);
+#else
+	out.port = pin;
+	out.mask = 1;
+#endif
+
+	// digitalWrite() also takes the pin off its PWM timer, which a port write would not.
+	pinMode(pin, OUTPUT);
+	digitalWrite(pin, LOW);
+	s_owned[out.port] |= out.mask;
+	s_shadow[out.port] &= ~out.mask;
+	return out;
+}
+
+
+/*
+ */
+void SeaRobOutput::Commit() {
+	SeaRobSoftPwm::Commit();
+	
+	if (s_anyDirty) {
+		s_anyDirty = false;
+		CommitPorts();
+	}
+	if (s_levelCommit != NULL) {
+		s_levelCommit();
+	}
+}
+
+
+/*
+ */
+void SeaRobOutput::CommitPorts() {
+	for (uint8_t port = 0 ; port < OUTPUT_MCU_PORTS ; port++) {
+		if (!s_dirty[port]) {
+			continue;
+		}
+		s_dirty[port] = false;
+		
+#if defined(__AVR__)
+		// Interrupt code may own other bits of the same port.
+		volatile uint8_t *reg = portOutputRegister(port);
+		uint8_t owned = s_owned[port];
+		noInterrupts();
+		*reg = (*reg & ~owned) | (s_shadow[port] & owned);
+		interrupts();
+#else
+		digitalWrite(port, s_shadow[port] & 1);
+#endif
+	}
+	
+	// The chain shifts as a whole.
+	bool shift = false;
+	for (uint8_t port = OUTPUT_CHAIN_PORT ; port < OUTPUT_EXPANDER_PORT ; port++) {
+		shift |= s_dirty[port];
+		s_dirty[port] = false;
+	}
+	if (shift) {
+		SeaRobShiftOut::Shift(&s_shadow[OUTPUT_CHAIN_PORT]);
+	}
+	
+	// Both latches of a chip in one transaction.
+	for (uint8_t chip = 0 ; chip < EXPANDER_MAX_CHIPS ; chip++) {
+		uint8_t port = OUTPUT_EXPANDER_PORT + 2 * chip;
+		if (s_dirty[port] || s_dirty[port + 1]) {
+			s_dirty[port] = false;
+			s_dirty[port + 1] = false;
+			SeaRobExpander::Write(chip, &s_shadow[port]);
+		}
+	}
+	
+	// Segments only go out with their strip, from SeaRobPixels::Commit().
+	for (uint8_t port = OUTPUT_PIXELS_PORT ; port < OUTPUT_PORTS ; port++) {
+		if (!s_dirty[port]) {
+			continue;
+		}
+		s_dirty[port] = false;
+		
+		for (uint8_t bit = 0 ; bit < 8 ; bit++) {
+			if (s_owned[port] & (1 << bit)) {
+				int pin = PIXELS_PIN_BASE + 8 * (port - OUTPUT_PIXELS_PORT) + bit;
+				WriteLevel(pin, (s_shadow[port] & (1 << bit)) ? 255 : 0);
+			}
+		}
+	}
+}
@@ -0,0 +1,98 @@
+#ifndef __searob_output_h__
+#define __searob_output_h__
+
+#include "Arduino.h"
+#include "SeaRobExpander.h"
+#include "SeaRobPixels.h"
+#include "SeaRobShiftOut.h"
+
+/*
+ * On the AVR the shadows are the PORTx registers, indexed by digitalPinToPort() (PA-PL on the
+ * Mega). Elsewhere (the simulator) every pin is its own one-bit port, committed with digitalWrite.
+ * The 74HC595 registers of SeaRobShiftOut follow, one port each, then GPIOA and GPIOB of each
+ * SeaRobExpander chip, then the SeaRobPixels segments, eight to a port.
+ */
+#if defined(__AVR__)
+#define OUTPUT_MCU_PORTS 	13
+#else
+#define OUTPUT_MCU_PORTS 	NUM_DIGITAL_PINS
+#endif
+#define OUTPUT_CHAIN_PORT 	OUTPUT_MCU_PORTS
+#define OUTPUT_EXPANDER_PORT 	(OUTPUT_CHAIN_PORT + SHIFTOUT_MAX_REGISTERS)
+#define OUTPUT_PIXELS_PORT 	(OUTPUT_EXPANDER_PORT + 2 * EXPANDER_MAX_CHIPS)
+#define OUTPUT_PORTS 		(OUTPUT_PIXELS_PORT + (PIXELS_MAX_SEGMENTS + 7) / 8)
+
+/*
+ * Where one output pin lives in the shadows; looked up once, by Attach().
+ */
+typedef struct {
+  uint8_t		port;
+  uint8_t		mask;
+} SeaRobOutputPin;
+
+
+/*
+ * Hooks for outputs that take a level, installed by their module when it is first used.
+ */
+typedef void (*onOutputLevel) (int pin, uint8_t level);
+typedef void (*onOutputCommit) ();
+
+
+/*
+ * Staged digital outputs. Lights and motors write into shadow port images, which costs a
+ * couple of instructions and nothing at all when the level is unchanged; Commit(), once per
+ * loop(), then writes each port that changed in one go. Every pin on a port switches in the
+ * same instant, and only the bits that were attached here are touched.
+ *
+ * Not for PWM: analogWrite() pins stay with the Arduino core. Commit() also hands the
+ * SeaRobSoftPwm levels to its ISR, shifts out the SeaRobShiftOut chain when one of its
+ * virtual pins changed, writes the latches of each SeaRobExpander chip that did, and sends
+ * the SeaRobPixels strips that changed; an on/off segment is full color or dark. SeaRobPixels
+ * hooks itself in from AddStrip(), so a sketch without strips links none of its buffers.
+ */
+class SeaRobOutput {
+  public:
+  		// Makes the pin an output, driven LOW until the first commit says otherwise.
+  		static SeaRobOutputPin	Attach(int pin);
+  		
+  		// On a shift register, an expander or a pixel strip: not a pin of the board.
+  		static bool		IsVirtual(int pin) {
+  		  return SeaRobShiftOut::IsVirtual(pin) || SeaRobExpander::IsVirtual(pin) || SeaRobPixels::IsVirtual(pin);
+  		}
+  		
+  		static void		Write(SeaRobOutputPin out, int level) {
+  		  uint8_t image = level ? (s_shadow[out.port] | out.mask) : (s_shadow[out.port] & ~out.mask);
+  		  if (image != s_shadow[out.port]) {
+  		    s_shadow[out.port] = image;
+  		    s_dirty[out.port] = true;
+  		    s_anyDirty = true;
+  		  }
+  		}
+  		
+  		// A segment's level, 0-255; dropped until a strip has been added.
+  		static void		WriteLevel(int pin, uint8_t level) {
+  		  if (s_levelHook != NULL) {
+  		    s_levelHook(pin, level);
+  		  }
+  		}
+  		
+  		static void		Commit();
+  		
+  		// Called by SeaRobPixels::AddStrip().
+  		static void		HookLevels(onOutputLevel level, onOutputCommit commit) {
+  		  s_levelHook = level;
+  		  s_levelCommit = commit;
+  		}
+  		
+  private:
+  		static void		CommitPorts();
+  		
+  		static uint8_t	s_shadow[OUTPUT_PORTS];
+  		static uint8_t	s_owned[OUTPUT_PORTS];
+  		static bool		s_dirty[OUTPUT_PORTS];
+  		static bool		s_anyDirty;
+  		static onOutputLevel	s_levelHook;
+  		static onOutputCommit	s_levelCommit;
+};
+
+#endif // __searob_output_h__
@@ -0,0 +1,61 @@
+#ifndef __searob_pattern_h__
+#define __searob_pattern_h__
+
+#include "Arduino.h"
+
+// Frame masks are one byte: a pattern drives at most this many lights, and is compiled once
+// for every light count from 1 up to it.
+#define PATTERN_MAX_LIGHTS 	8
+
+
+/*
+ * A compiled light pattern: a table in flash holding, per frame, a bitmask of the lights
+ * that are lit (bit 0 is the first light). Playing it is a table read per frame edge.
+ * frameMillis of 0 means a still pattern: one frame, shown once.
+ */
+typedef struct {
+  const uint8_t *	frames; // PROGMEM
+  uint16_t			frameMillis;
+  uint8_t			frameCount;
+} SeaRobPattern;
+
+
+/*
+ * The compiler. A pattern is described by a struct with
+ *
+ *   enum { FrameMillis = ... };
+ *   static constexpr int  Frames(int numLights);
+ *   static constexpr bool Lit(int numLights, int light, int frame);
+ *
+ * and SeaRobPatternFrames<P, N>::frames is the table for N lights, evaluated by the compiler
+ * into flash. PATTERN_ENTRIES(P) expands to its SeaRobPattern for every light count, to fill
+ * one row of a PROGMEM lookup table.
+ */
+template <int... I> struct SeaRobFrameSeq {};
+template <int K, int... I> struct SeaRobMakeFrameSeq : SeaRobMakeFrameSeq<K - 1, K - 1, I...> {};
+template <int... I> struct SeaRobMakeFrameSeq<0, I...> { typedef SeaRobFrameSeq<I...> Type; };
+
+template <class P, int N>
+constexpr uint8_t SeaRobPatternMask(int frame, int light = 0) {
+  return (light == N) ? 0 :
+    (uint8_t) ((P::Lit(N, light, frame) ? (1 << light) : 0) | SeaRobPatternMask<P, N>(frame, light + 1));
+}
+
+template <class P, int N, class Seq = typename SeaRobMakeFrameSeq<P::Frames(N)>::Type>
+struct SeaRobPatternFrames;
+
+template <class P, int N, int... F>
+struct SeaRobPatternFrames<P, N, SeaRobFrameSeq<F...> > {
+  static const uint8_t frames[sizeof...(F)] PROGMEM;
+};
+
+template <class P, int N, int... F>
+const uint8_t SeaRobPatternFrames<P, N, SeaRobFrameSeq<F...> >::frames[sizeof...(F)] PROGMEM = {
+  SeaRobPatternMask<P, N>(F)...
+};
+
+#define PATTERN_ENTRY(P, N) 	{ SeaRobPatternFrames<P, N>::frames, P::FrameMillis, P::Frames(N) }
+#define PATTERN_ENTRIES(P) 		{ PATTERN_ENTRY(P, 1), PATTERN_ENTRY(P, 2), PATTERN_ENTRY(P, 3), PATTERN_ENTRY(P, 4), \
+								  PATTERN_ENTRY(P, 5), PATTERN_ENTRY(P, 6), PATTERN_ENTRY(P, 7), PATTERN_ENTRY(P, 8) }
+
+#endif // __searob_pattern_h__
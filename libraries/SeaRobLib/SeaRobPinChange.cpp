@@ -0,0 +1,201 @@
+#include "Arduino.h"
+#include "SeaRobPinChange.h"
+#include "SeaRobLogger.h"
+
+
+/* static class objects (global) */
+SeaRobPinChange::Watch SeaRobPinChange::s_watches[PINCHANGE_MAX_PINS];
+SeaRobPinChange::Event SeaRobPinChange::s_queue[PINCHANGE_QUEUE_SIZE];
+volatile uint8_t SeaRobPinChange::s_head = 0;
+volatile uint8_t SeaRobPinChange::s_tail = 0;
+volatile unsigned long SeaRobPinChange::s_overflows = 0;
+
+#define PINCHANGE_QUEUE_MASK (PINCHANGE_QUEUE_SIZE - 1)
+
+
+#if defined(PCICR)
+
+ISR(PCINT0_vect) {
+	SeaRobPinChange::HandleInterrupt(0);
+}
+
+ISR(PCINT1_vect) {
+	SeaRobPinChange::HandleInterrupt(1);
+}
+
+#if defined(PCINT2_vect)
+ISR(PCINT2_vect) {
+	SeaRobPinChange::HandleInterrupt(2);
+}
+#endif
+
+
+/*
+ */
+bool SeaRobPinChange::IsAvailable(int pin) {
+	return digitalPinToPCMSK(pin) != 0;
+}
+
+
+/*
+ */
+int SeaRobPinChange::Attach(int pin, unsigned int debounceMillis, onPinChange handler, void *opaque) {
+	if (!IsAvailable(pin)) {
+		return -1;
+	}
+	
+	int handle = 0;
+	while ((handle < PINCHANGE_MAX_PINS) && (s_watches[handle].handler != NULL)) {
+		handle++;
+	}
+	if (handle == PINCHANGE_MAX_PINS) {
+		bclogger_error("SeaRobPinChange: no room for pin %d", pin);
+		return -1;
+	}
+	
+	Watch *watch = &s_watches[handle];
+	noInterrupts();
+	watch->inputRegister = portInputRegister(digitalPinToPort(pin));
+	watch->mask = digitalPinToBitMask(pin);
+	watch->level = (*watch->inputRegister & watch->mask) ? HIGH : LOW;
+	watch->swallowed = false;
+	watch->lastEdge = millis();
+	watch->debounceMillis = debounceMillis;
+	watch->opaque = opaque;
+	watch->handler = handler;
+	watch->bank = digitalPinToPCICRbit(pin);
+	*digitalPinToPCMSK(pin) |= _BV(digitalPinToPCMSKbit(pin));
+	*digitalPinToPCICR(pin) |= _BV(digitalPinToPCICRbit(pin));
+	interrupts();
+	
+	bclogger("SeaRobPinChange: pin %d on bank %d, debounce=%u", pin, watch->bank, debounceMillis);
+	return handle;
+}
+
+
+/*
+ * Leaves the bank's interrupt enabled; other pins may still be on it, and a stray one is cheap.
+ */
+void SeaRobPinChange::Detach(int handle) {
+	if ((handle < 0) || (handle >= PINCHANGE_MAX_PINS)) {
+		return;
+	}
+	noInterrupts();
+	s_watches[handle].handler = NULL;
+	interrupts();
+}
+
+
+/*
+ */
+void SeaRobPinChange::HandleInterrupt(uint8_t bank) {
+	unsigned long now = millis();
+	for (uint8_t i = 0 ; i < PINCHANGE_MAX_PINS ; i++) {
+		Watch *watch = &s_watches[i];
+		if ((watch->handler == NULL) || (watch->bank != bank)) {
+			continue;
+		}
+		uint8_t level = (*watch->inputRegister & watch->mask) ? HIGH : LOW;
+		if (level == watch->level) {
+			continue;
+		}
+		if ((now - watch->lastEdge) < watch->debounceMillis) {
+			watch->swallowed = true;
+			continue;
+		}
+		if (Push(i, level, now)) {
+			watch->level = level;
+			watch->lastEdge = now;
+			watch->swallowed = false;
+		} else {
+			// Queue full: lost like a bounce, so Dispatch() settles on the real level later.
+			watch->swallowed = true;
+		}
+	}
+}
+
+#else
+
+bool SeaRobPinChange::IsAvailable(int) {
+	return false;
+}
+
+int SeaRobPinChange::Attach(int, unsigned int, onPinChange, void *) {
+	return -1;
+}
+
+void SeaRobPinChange::Detach(int) {
+}
+
+void SeaRobPinChange::HandleInterrupt(uint8_t) {
+}
+
+#endif // PCICR
+
+
+/*
+ */
+bool SeaRobPinChange::Push(uint8_t handle, uint8_t level, unsigned long edgeTime) {
+	uint8_t head = s_head;
+	uint8_t next = (head + 1) & PINCHANGE_QUEUE_MASK;
+	if (next == s_tail) {
+		s_overflows++;
+		return false;
+	}
+	s_queue[head].handle = handle;
+	s_queue[head].level = level;
+	s_queue[head].edgeTime = edgeTime;
+	s_head = next;
+	return true;
+}
+
+
+/*
+ */
+void SeaRobPinChange::Dispatch() {
+	uint8_t tail = s_tail;
+	while (tail != s_head) {
+		Event event = s_queue[tail];
+		tail = (tail + 1) & PINCHANGE_QUEUE_MASK;
+		s_tail = tail;
+		
+		Watch *watch = &s_watches[event.handle];
+		if (watch->handler) {
+			watch->handler(watch->opaque, event.level, event.edgeTime);
+		}
+	}
+	
+	// Edges swallowed by the debounce may have left the pin somewhere other than the last
+	// queued level; once the window has passed, whatever it reads now is the settled level.
+	unsigned long now = millis();
+	for (uint8_t i = 0 ; i < PINCHANGE_MAX_PINS ; i++) {
+		Watch *watch = &s_watches[i];
+		if (!watch->swallowed || (watch->handler == NULL)) {
+			continue;
+		}
+		
+		noInterrupts();
+		unsigned long lastEdge = watch->lastEdge;
+		interrupts();
+		if ((now - lastEdge) < watch->debounceMillis) {
+			continue;
+		}
+		
+		// Not while an edge is queued, or it would be delivered after the newer level.
+		noInterrupts();
+		if (s_head != s_tail) {
+			interrupts();
+			break;
+		}
+		uint8_t level = (*watch->inputRegister & watch->mask) ? HIGH : LOW;
+		bool changed = (level != watch->level);
+		watch->level = level;
+		watch->lastEdge = now;
+		watch->swallowed = false;
+		interrupts();
+		
+		if (changed) {
+			watch->handler(watch->opaque, level, now);
+		}
+	}
+}
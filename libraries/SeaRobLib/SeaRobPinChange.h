@@ -0,0 +1,76 @@
+#ifndef __searob_pinchange_h__
+#define __searob_pinchange_h__
+
+#include "Arduino.h"
+
+// The PCINT vectors keep this storage linked into every sketch, used or not: 16 bytes a pin
+// and 6 an event on the Mega. A sketch that moves more buttons onto interrupts raises these.
+#ifndef PINCHANGE_MAX_PINS
+#define PINCHANGE_MAX_PINS 		4
+#endif
+// Two edges a pin between Dispatch() calls; a power of two, at most 128.
+#ifndef PINCHANGE_QUEUE_SIZE
+#define PINCHANGE_QUEUE_SIZE 	8
+#endif
+
+/*
+ * Called from Dispatch(), in the main loop, with the level the pin settled on and the millis
+ * of the edge as the ISR saw it.
+ */
+typedef void (*onPinChange) (void *opaque, int level, unsigned long edgeTime);
+
+
+/*
+ * Pin-change interrupt input for the Mega's PCINT banks (D10-D13, D50-D53, D14/D15, A8-A15).
+ * The ISR timestamps each edge and queues it, with a lockout debounce: an edge inside the
+ * window of the last one is not queued, only noted. The queue has one producer (the ISRs)
+ * and one consumer (Dispatch()), so neither side ever has to disable interrupts to use it.
+ *
+ * Dispatch() then delivers from the main loop, and re-reads a pin once its window has passed
+ * if edges were swallowed, so the last delivered level is always the one the pin settled on.
+ *
+ * Owns the PCINT0-2 vectors, so it cannot be used together with SoftwareSerial. Unavailable on
+ * boards without PCICR (and in the simulator); Attach() then fails and callers keep polling.
+ */
+class SeaRobPinChange {
+  public:
+  		static bool		IsAvailable(int pin);
+  		// Returns a handle for Detach(), or -1.
+  		static int		Attach(int pin, unsigned int debounceMillis, onPinChange handler, void *opaque);
+  		static void		Detach(int handle);
+  		
+  		static void		Dispatch();
+  		static unsigned long	GetOverflowCount() { return s_overflows; }
+  		
+  		// Called by the PCINTn ISRs only.
+  		static void		HandleInterrupt(uint8_t bank);
+  		
+  private:
+  		typedef struct {
+  		  volatile uint8_t *	inputRegister;
+  		  uint8_t				mask;
+  		  uint8_t				bank;
+  		  volatile uint8_t		level; // last queued level
+  		  volatile bool			swallowed; // an edge fell inside the debounce window
+  		  volatile unsigned long	lastEdge;
+  		  unsigned int			debounceMillis;
+  		  onPinChange			handler; // NULL when the slot is free
+  		  void *				opaque;
+  		} Watch;
+  		
+  		typedef struct {
+  		  uint8_t				handle;
+  		  uint8_t				level;
+  		  unsigned long			edgeTime;
+  		} Event;
+  		
+  		static bool		Push(uint8_t handle, uint8_t level, unsigned long edgeTime);
+  		
+  		static Watch			s_watches[PINCHANGE_MAX_PINS];
+  		static Event			s_queue[PINCHANGE_QUEUE_SIZE];
+  		static volatile uint8_t	s_head; // written by the ISRs only
+  		static volatile uint8_t	s_tail; // written by Dispatch() only
+  		static volatile unsigned long	s_overflows;
+};
+
+#endif // __searob_pinchange_h__
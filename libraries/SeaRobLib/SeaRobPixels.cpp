@@ -0,0 +1,206 @@
+#include "Arduino.h"
+#include "SeaRobLogger.h"
+#include "SeaRobOutput.h"
+#include "SeaRobPixels.h"
+#if !defined(__AVR__)
+#include "SeaRobSim.h"
+#endif
+
+
+/* static class objects (global) */
+uint8_t SeaRobPixels::s_pixels[3 * PIXELS_MAX_PIXELS];
+uint16_t SeaRobPixels::s_pixelCount = 0;
+SeaRobPixels::Strip SeaRobPixels::s_strips[PIXELS_MAX_STRIPS];
+uint8_t SeaRobPixels::s_stripCount = 0;
+SeaRobPixels::Segment SeaRobPixels::s_segments[PIXELS_MAX_SEGMENTS];
+uint8_t SeaRobPixels::s_segmentCount = 0;
+bool SeaRobPixels::s_dirty = false;
+
+
+/*
+ */
+int SeaRobPixels::AddStrip(int dataPin, int pixelCount) {
+	if ((s_stripCount == PIXELS_MAX_STRIPS) || (pixelCount <= 0) || (pixelCount > PIXELS_MAX_STRIP_PIXELS)
+			|| (s_pixelCount + pixelCount > PIXELS_MAX_PIXELS)) {
+		bclogger_error("SeaRobPixels: no room for %d pixels on pin %d", pixelCount, dataPin);
+		return -1;
+	}
+
+	Strip *strip = &s_strips[s_stripCount];
+	strip->pin = dataPin;
+	strip->pixelCount = pixelCount;
+	strip->first = 3 * s_pixelCount;
+	strip->dirty = true;
+	strip->sent = micros() - PIXELS_LATCH_MICROS;
+	s_pixelCount += pixelCount;
+	s_dirty = true;
+	SeaRobOutput::HookLevels(Set, Commit);
+
+	pinMode(dataPin, OUTPUT);
+	digitalWrite(dataPin, LOW);
+#if defined(__AVR__)
+	strip->port = portOutputRegister(digitalPinToPort(dataPin));
+	strip->mask = digitalPinToBitMask(dataPin);
+#endif
+
+	bclogger("SeaRobPixels: strip %d on pin %d, %d pixels", s_stripCount, dataPin, pixelCount);
+	return s_stripCount++;
+}
+
+
+/*
+ */
+int SeaRobPixels::AddSegment(int strip, int firstPixel, int pixelCount, uint8_t red, uint8_t green, uint8_t blue) {
+	if ((strip < 0) || (strip >= s_stripCount) || (firstPixel < 0) || (pixelCount <= 0)
+			|| (firstPixel + pixelCount > s_strips[strip].pixelCount) || (pixelCount > 255)) {
+		bclogger_error("SeaRobPixels: no pixels %d-%d on strip %d", firstPixel, firstPixel + pixelCount - 1, strip);
+		return -1;
+	}
+	if (s_segmentCount == PIXELS_MAX_SEGMENTS) {
+		bclogger_error("SeaRobPixels: no room for a segment on strip %d", strip);
+		return -1;
+	}
+
+	Segment *segment = &s_segments[s_segmentCount];
+	segment->strip = strip;
+	segment->pixelCount = pixelCount;
+	segment->first = s_strips[strip].first + 3 * firstPixel;
+	segment->color[0] = green;
+	segment->color[1] = red;
+	segment->color[2] = blue;
+	segment->level = 0;
+
+	int pin = PIXELS_PIN_BASE + s_segmentCount++;
+	bclogger("SeaRobPixels: pin %d is pixels %d-%d of strip %d", pin, firstPixel, firstPixel + pixelCount - 1, strip);
+	return pin;
+}
+
+
+/*
+ * Level 255 is the segment's color; below that, each channel scaled down in proportion.
+ */
+void SeaRobPixels::Set(int pin, uint8_t level) {
+	Segment *segment = &s_segments[pin - PIXELS_PIN_BASE];
+	if (level == segment->level) {
+		return;
+	}
+	segment->level = level;
+
+	uint16_t scale = level + 1;
+	uint8_t grb[3];
+	for (uint8_t i = 0 ; i < 3 ; i++) {
+		grb[i] = (segment->color[i] * scale) >> 8;
+	}
+	uint8_t *pixel = &s_pixels[segment->first];
+	for (uint8_t i = 0 ; i < segment->pixelCount ; i++) {
+		*pixel++ = grb[0];
+		*pixel++ = grb[1];
+		*pixel++ = grb[2];
+	}
+	s_strips[segment->strip].dirty = true;
+	s_dirty = true;
+}
+
+
+/*
+ */
+void SeaRobPixels::SetPixel(int strip, int pixel, uint8_t red, uint8_t green, uint8_t blue) {
+	if ((strip < 0) || (strip >= s_stripCount) || (pixel < 0) || (pixel >= s_strips[strip].pixelCount)) {
+		return;
+	}
+	uint8_t *grb = &s_pixels[s_strips[strip].first + 3 * pixel];
+	if ((grb[0] == green) && (grb[1] == red) && (grb[2] == blue)) {
+		return;
+	}
+	grb[0] = green;
+	grb[1] = red;
+	grb[2] = blue;
+	s_strips[strip].dirty = true;
+	s_dirty = true;
+}
+
+
+/*
+ * A strip still latching its last frame waits for a later commit.
+ */
+void SeaRobPixels::Commit() {
+	if (!s_dirty) {
+		return;
+	}
+	s_dirty = false;
+
+	for (uint8_t i = 0 ; i < s_stripCount ; i++) {
+		Strip *strip = &s_strips[i];
+		if (!strip->dirty) {
+			continue;
+		}
+		if ((uint32_t) (micros() - strip->sent) < PIXELS_LATCH_MICROS) {
+			s_dirty = true;
+			continue;
+		}
+		strip->dirty = false;
+		Send(strip);
+		strip->sent = micros();
+	}
+}
+
+
+/*
+ * Bits go out MSB first. A bit's high time is set by where the data pin goes low: the second
+ * store for a 0, the third for a 1; the byte is shifted, and the next one loaded, in the time
+ * between. The cycle counts on the right are from the start of the bit.
+ */
+void SeaRobPixels::Send(Strip *strip) {
+#if defined(__AVR__)
+#if F_CPU != 16000000L
+#error "SeaRobPixels: the send loop is timed for a 16MHz clock"
+#endif
+	const uint8_t *ptr = &s_pixels[strip->first];
+	uint16_t count = 3 * strip->pixelCount;
+	volatile uint8_t *port = strip->port;
+	uint8_t byte = *ptr++;
+	uint8_t bits = 8;
+
+	// Interrupt code may own other bits of the data pin's port, and must not stretch a bit.
+	noInterrupts();
+	uint8_t hi = *port | strip->mask;
+	uint8_t lo = *port & ~strip->mask;
+	uint8_t next = lo;
+	asm volatile(
+		"1:"							"\n\t"
+		"st   %a[port], %[hi]"			"\n\t" // 2		high					(2)
+		"sbrc %[byte], 7"				"\n\t" // 1-2	a 1 stays high
+		"mov  %[next], %[hi]"			"\n\t" // 0-1							(4)
+		"dec  %[bits]"					"\n\t" // 1								(5)
+		"st   %a[port], %[next]"		"\n\t" // 2		low, for a 0			(7)
+		"mov  %[next], %[lo]"			"\n\t" // 1								(8)
+		"breq 2f"						"\n\t" // 1-2	the byte's last bit
+		"rol  %[byte]"					"\n\t" // 1								(10)
+		"rjmp .+0"						"\n\t" // 2								(12)
+		"nop"							"\n\t" // 1								(13)
+		"st   %a[port], %[lo]"			"\n\t" // 2		low, for a 1			(15)
+		"nop"							"\n\t" // 1								(16)
+		"rjmp .+0"						"\n\t" // 2								(18)
+		"rjmp 1b"						"\n\t" // 2								(20)
+		"2:"							"\n\t" //								(10)
+		"ldi  %[bits], 8"				"\n\t" // 1								(11)
+		"ld   %[byte], %a[ptr]+"		"\n\t" // 2								(13)
+		"st   %a[port], %[lo]"			"\n\t" // 2		low, for a 1			(15)
+		"nop"							"\n\t" // 1								(16)
+		"sbiw %[count], 1"				"\n\t" // 2								(18)
+		"brne 1b"						"\n\t" // 2								(20)
+		: [port] "+e" (port), [ptr] "+e" (ptr), [byte] "+r" (byte), [bits] "+d" (bits),
+		  [next] "+r" (next), [count] "+w" (count)
+		: [hi] "r" (hi), [lo] "r" (lo));
+	interrupts();
+#else
+	const uint8_t *ptr = &s_pixels[strip->first];
+	for (uint16_t i = 0 ; i < 3 * strip->pixelCount ; i++) {
+		uint8_t byte = *ptr++;
+		for (uint8_t bit = 0x80 ; bit ; bit >>= 1) {
+			unsigned long high = (byte & bit) ? PIXELS_T1H_CYCLES : PIXELS_T0H_CYCLES;
+			SeaRobSim::Pulse(strip->pin, high * PIXELS_CYCLE_PICOS, (PIXELS_BIT_CYCLES - high) * PIXELS_CYCLE_PICOS);
+		}
+	}
+#endif
+}
@@ -0,0 +1,112 @@
+#ifndef __searob_pixels_h__
+#define __searob_pixels_h__
+
+#include "Arduino.h"
+#include "SeaRobExpander.h"
+
+// Virtual pins: PIXELS_PIN_BASE + segment, in the order AddSegment() made them. After the
+// SeaRobExpander pins.
+#ifndef PIXELS_PIN_BASE
+#define PIXELS_PIN_BASE 			(EXPANDER_PIN_BASE + 16 * EXPANDER_MAX_CHIPS)
+#endif
+#ifndef PIXELS_MAX_SEGMENTS
+#define PIXELS_MAX_SEGMENTS 		64
+#endif
+#ifndef PIXELS_MAX_STRIPS
+#define PIXELS_MAX_STRIPS 			4
+#endif
+// A strip goes out with interrupts masked, 30us a pixel; 32 pixels keep that under the 1.024ms
+// between timer 0 overflows, so millis() is late by up to a millisecond but loses no tick.
+#ifndef PIXELS_MAX_STRIP_PIXELS
+#define PIXELS_MAX_STRIP_PIXELS 	32
+#endif
+// Across all strips; the SRAM cost is 3 bytes a pixel.
+#ifndef PIXELS_MAX_PIXELS
+#define PIXELS_MAX_PIXELS 			(PIXELS_MAX_STRIPS * PIXELS_MAX_STRIP_PIXELS)
+#endif
+
+// Data held low this long latches a frame; newer WS2812B parts want more than the 50us of
+// the original datasheet.
+#define PIXELS_LATCH_MICROS 		300
+
+// The AVR send loop, in cycles of the Mega's 16MHz clock (62.5ns): a bit every 20 cycles,
+// high for 5 of them for a 0 and 13 for a 1. The WS2812 wants 0.40us and 0.80us, +-150ns.
+#define PIXELS_BIT_CYCLES 			20
+#define PIXELS_T0H_CYCLES 			5
+#define PIXELS_T1H_CYCLES 			13
+#define PIXELS_CYCLE_PICOS 			62500UL
+
+
+/*
+ * WS2812 (NeoPixel) strips, each on one data pin: a single wire in place of a transistor
+ * output per light. The pixels of all strips share one buffer, 3 bytes each in the order
+ * the strip takes them (green, red, blue), so sending is a straight walk through memory.
+ *
+ * A segment is a run of pixels on one strip, with a color, standing in for one light: it
+ * gets a virtual pin, and a SeaRobLight, a SeaRobLightBank slot or a SeaRobSpringButtonLightList
+ * on that pin sets the segment's level, 0-255, which scales its color. A segment dims, so
+ * fades and dimmable lights work on it as on a PWM pin. SetPixel() paints single pixels.
+ *
+ * Like every other output, nothing is sent until SeaRobOutput::Commit(), and then only the
+ * strips that changed, each no sooner than PIXELS_LATCH_MICROS after its last frame. A strip
+ * is sent with interrupts masked throughout, 30us a pixel, as a pause would latch half a
+ * frame. Timer 0 holds one overflow pending, so millis() loses a tick for every 1.024ms
+ * masked beyond the first; AddStrip() refuses strips longer than PIXELS_MAX_STRIP_PIXELS,
+ * which stay under that. Interrupts come back between strips, so more pixels take more
+ * strips, each on its own pin. SeaRobSoftPwm still stutters while a strip is going out.
+ *
+ * In the simulator each bit becomes a pulse on the data pin, with the AVR loop's timing, for
+ * a WS2812 model to decode (SeaRobSim::AttachWs2812).
+ */
+class SeaRobPixels {
+  public:
+  		// Makes the pin an output for a strip of pixelCount pixels, all dark. Returns the
+  		// strip, or -1 when out of room or over PIXELS_MAX_STRIP_PIXELS.
+  		static int		AddStrip(int dataPin, int pixelCount);
+  		// Returns the segment's virtual pin, or -1. It starts dark.
+  		static int		AddSegment(int strip, int firstPixel, int pixelCount, uint8_t red, uint8_t green, uint8_t blue);
+
+  		static bool		IsVirtual(int pin) {
+  		  return (pin >= PIXELS_PIN_BASE) && (pin < PIXELS_PIN_BASE + PIXELS_MAX_SEGMENTS);
+  		}
+
+  		// Called through SeaRobOutput::WriteLevel().
+  		static void		Set(int pin, uint8_t level);
+  		static void		SetPixel(int strip, int pixel, uint8_t red, uint8_t green, uint8_t blue);
+
+  		// Called by SeaRobOutput::Commit(), once AddStrip() has hooked it in.
+  		static void		Commit();
+
+  private:
+  		typedef struct {
+  		  uint8_t				pin;
+  		  uint16_t				pixelCount;
+  		  uint16_t				first; // in s_pixels, in bytes
+  		  bool					dirty;
+  		  unsigned long			sent; // micros() at the end of the last frame
+#if defined(__AVR__)
+  		  volatile uint8_t *	port;
+  		  uint8_t				mask;
+#endif
+  		} Strip;
+
+  		typedef struct {
+  		  uint8_t				strip;
+  		  uint8_t				pixelCount;
+  		  uint16_t				first; // in s_pixels, in bytes
+  		  uint8_t				color[3]; // green, red, blue
+  		  uint8_t				level;
+  		} Segment;
+
+  		static void		Send(Strip *strip);
+
+  		static uint8_t			s_pixels[3 * PIXELS_MAX_PIXELS];
+  		static uint16_t			s_pixelCount;
+  		static Strip			s_strips[PIXELS_MAX_STRIPS];
+  		static uint8_t			s_stripCount;
+  		static Segment			s_segments[PIXELS_MAX_SEGMENTS];
+  		static uint8_t			s_segmentCount;
+  		static bool				s_dirty; // some strip is
+};
+
+#endif // __searob_pixels_h__
@@ -0,0 +1,167 @@
+#include "Arduino.h"
+#include "SeaRobArena.h"
+#include "SeaRobProfiler.h"
+#include "SeaRobLogger.h"
+
+
+#if SEAROB_PROFILER
+
+/* static class objects (global) */
+SeaRobProfiler::Section SeaRobProfiler::s_sections[PROFILER_MAX_SECTIONS];
+int SeaRobProfiler::s_sectionCount = 0;
+
+
+/*
+ */
+int SeaRobProfiler::AddSection(const __FlashStringHelper *name) {
+	if (s_sectionCount >= PROFILER_MAX_SECTIONS) {
+		bclogger("SeaRobProfiler: no room for section %S", name);
+		return -1;
+	}
+	
+	int sectionId = s_sectionCount++;
+	s_sections[sectionId].name = name;
+	ResetSection(&s_sections[sectionId]);
+	return sectionId;
+}
+
+
+/*
+ */
+void SeaRobProfiler::Record(int sectionId, unsigned long elapsedMicros) {
+	if ((sectionId < 0) || (sectionId >= s_sectionCount)) {
+		return;
+	}
+	
+	Section *section = &s_sections[sectionId];
+	if (section->totalMicros + elapsedMicros < section->totalMicros) {
+		section->totalMicros >>= 1;
+		section->count >>= 1;
+	}
+	section->count++;
+	section->totalMicros += elapsedMicros;
+	if (elapsedMicros < section->minMicros) {
+		section->minMicros = elapsedMicros;
+	}
+	if (elapsedMicros > section->maxMicros) {
+		section->maxMicros = elapsedMicros;
+	}
+	
+	// Bucket by the number of significant bits.
+	int bucket = 0;
+	while (elapsedMicros && (bucket < (PROFILER_BUCKETS - 1))) {
+		elapsedMicros >>= 1;
+		bucket++;
+	}
+	if (section->histogram[bucket] != 0xFFFF) {
+		section->histogram[bucket]++;
+	}
+}
+
+
+/*
+ */
+void SeaRobProfiler::Reset() {
+	for (int i = 0 ; i < s_sectionCount ; i++) {
+		ResetSection(&s_sections[i]);
+	}
+}
+
+
+/*
+ */
+void SeaRobProfiler::ResetSection(Section *section) {
+	section->count = 0;
+	section->minMicros = 0xFFFFFFFFUL;
+	section->maxMicros = 0;
+	section->totalMicros = 0;
+	for (int b = 0 ; b < PROFILER_BUCKETS ; b++) {
+		section->histogram[b] = 0;
+	}
+}
+
+
+/*
+ */
+void SeaRobProfiler::Dump() {
+	// Asked for by hand, so let the loop stall rather than lose half of it.
+	bool wasAsync = bclogger_setAsync(false);
+	bclogger("SeaRobProfiler: %d sections, times in micros, histogram buckets are 0,1,2-3,4-7,...", s_sectionCount);
+	
+	char histogram[PROFILER_BUCKETS * 6 + 1];
+	for (int i = 0 ; i < s_sectionCount ; i++) {
+		Section *section = &s_sections[i];
+		if (section->count == 0) {
+			bclogger("SeaRobProfiler [%S] no samples", section->name);
+			continue;
+		}
+		
+		unsigned long mean = section->totalMicros / section->count;
+		bclogger("SeaRobProfiler [%S] n=%lu min=%lu mean=%lu max=%lu", 
+			section->name, section->count, section->minMicros, mean, section->maxMicros);
+		
+		int len = 0;
+		for (int b = 0 ; b < PROFILER_BUCKETS ; b++) {
+			len += snprintf(histogram + len, sizeof(histogram) - len, " %u", section->histogram[b]);
+		}
+		bclogger("SeaRobProfiler [%S] histogram:%s", section->name, histogram);
+	}
+	bclogger_setAsync(wasAsync);
+}
+
+
+/*
+ */
+void SeaRobProfiler::GetOverlayString(int sectionId, char *buf, int buflen) {
+	if ((sectionId < 0) || (sectionId >= s_sectionCount) || (s_sections[sectionId].count == 0)) {
+		snprintf(buf, buflen, "prof: n/a");
+		return;
+	}
+	
+	Section *section = &s_sections[sectionId];
+	unsigned long mean = section->totalMicros / section->count;
+	snprintf_P(buf, buflen, PSTR("%S %luus <%luus"), section->name, mean, section->maxMicros);
+}
+
+#else
+
+int SeaRobProfiler::AddSection(const __FlashStringHelper *) {
+	return -1;
+}
+
+void SeaRobProfiler::Record(int, unsigned long) {
+}
+
+void SeaRobProfiler::Reset() {
+}
+
+void SeaRobProfiler::Dump() {
+	bclogger("SeaRobProfiler: compiled out, SEAROB_PROFILER is 0");
+}
+
+void SeaRobProfiler::GetOverlayString(int, char *buf, int buflen) {
+	snprintf(buf, buflen, "prof: off");
+}
+
+#endif // SEAROB_PROFILER
+
+
+/*
+ */
+void SeaRobProfiler::ProcessSerialCommand() {
+	while (Serial.available() > 0) {
+		switch (Serial.read()) {
+		case 'p':
+			Dump();
+			break;
+		case 'r':
+			Reset();
+			bclogger("SeaRobProfiler: reset");
+			break;
+		case 'm':
+			SeaRobArena::Dump();
+			break;
+		}
+	}
+}
+
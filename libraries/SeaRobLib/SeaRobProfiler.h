@@ -0,0 +1,76 @@
+#ifndef __searob_profiler_h__
+#define __searob_profiler_h__
+
+#include "Arduino.h"
+
+// Set to 0 to compile every profile scope, and the sections' storage, away.
+#ifndef SEAROB_PROFILER
+#define SEAROB_PROFILER 1
+#endif
+
+// 50 bytes each; the largest sketch registers 5.
+#ifndef PROFILER_MAX_SECTIONS
+#define PROFILER_MAX_SECTIONS 	5
+#endif
+#define PROFILER_BUCKETS 		16 // bucket n counts durations of n significant bits: 0us, 1us, 2-3us, 4-7us, ... 16ms+
+
+
+/*
+ * Loop timing statistics per named section of code: min/max/mean and a log2 histogram of how
+ * long each pass took, in micros. Cheap enough to leave on: recording one sample is a few
+ * shifts and adds, no division.
+ *
+ * The total behind the mean is 32 bits; once it would pass 2^32us (71 minutes of the section)
+ * the total and the count are both halved, so n and the mean go on covering the later samples.
+ */
+class SeaRobProfiler {
+  public:
+  		// Registers a section under a name in flash, F("..."). Returns the id, or -1 when full.
+  		static int		AddSection(const __FlashStringHelper *name);
+  		static void		Record(int sectionId, unsigned long elapsedMicros);
+  		static void		Reset();
+  		
+  		// Logs every section, with its histogram.
+  		static void		Dump();
+  		// Serial commands: 'p' dumps the profile, 'r' resets it, 'm' dumps SeaRobArena.
+  		static void		ProcessSerialCommand();
+  		// One short line for the OLED: mean and max of a section.
+  		static void		GetOverlayString(int sectionId, char *buf, int buflen);
+  		
+#if SEAROB_PROFILER
+  private:
+  		typedef struct {
+  		  const __FlashStringHelper *	name;
+  		  unsigned long			count;
+  		  unsigned long			minMicros;
+  		  unsigned long			maxMicros;
+  		  unsigned long			totalMicros;
+  		  unsigned int			histogram[PROFILER_BUCKETS];
+  		} Section;
+  		
+  		static void		ResetSection(Section *section);
+  		
+  		static Section	s_sections[PROFILER_MAX_SECTIONS];
+  		static int		s_sectionCount;
+#endif
+};
+
+
+/*
+ * Times the enclosing block into one section.
+ */
+class SeaRobProfileScope {
+  public:
+#if SEAROB_PROFILER
+  		SeaRobProfileScope(int sectionId) : _sectionId(sectionId), _start(micros()) {}
+  		~SeaRobProfileScope() { SeaRobProfiler::Record(_sectionId, micros() - _start); }
+  		
+  private:
+  		const int				_sectionId;
+  		const unsigned long		_start;
+#else
+  		SeaRobProfileScope(int /*sectionId*/) {}
+#endif
+};
+
+#endif // __searob_profiler_h__
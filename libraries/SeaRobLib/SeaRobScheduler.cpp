@@ -0,0 +1,179 @@
+#include "Arduino.h"
+#include "SeaRobClock.h"
+#include "SeaRobInput.h"
+#include "SeaRobScheduler.h"
+#include "SeaRobObject.h"
+#include "SeaRobLogger.h"
+#include "SeaRobPinChange.h"
+
+
+/* static class objects (global) */
+SeaRobObject * SeaRobScheduler::s_timers[SCHEDULER_MAX_TIMERS];
+int SeaRobScheduler::s_timerCount = 0;
+int SeaRobScheduler::s_timerPeak = 0;
+SeaRobObject * SeaRobScheduler::s_inputs[SCHEDULER_MAX_INPUTS];
+int SeaRobScheduler::s_inputCount = 0;
+
+
+/*
+ */
+bool SeaRobScheduler::ScheduleAt(SeaRobObject *obj, unsigned long when) {
+	if (obj->_timerSlot >= 0) {
+		bool earlier = IsBefore(when, obj->_scheduledTime);
+		obj->_scheduledTime = when;
+		if (earlier) {
+			SiftUp(obj->_timerSlot);
+		} else {
+			SiftDown(obj->_timerSlot);
+		}
+		return true;
+	}
+	
+	if (s_timerCount >= SCHEDULER_MAX_TIMERS) {
+		bclogger_error("SeaRobScheduler: no room to schedule object %d", obj->_objId);
+		return false;
+	}
+	
+	obj->_scheduledTime = when;
+	Place(obj, s_timerCount++);
+	SiftUp(obj->_timerSlot);
+	if (s_timerCount > s_timerPeak) {
+		s_timerPeak = s_timerCount;
+	}
+	return true;
+}
+
+
+/*
+ */
+void SeaRobScheduler::Cancel(SeaRobObject *obj) {
+	if (obj->_timerSlot >= 0) {
+		RemoveAt(obj->_timerSlot);
+	}
+}
+
+
+/*
+ */
+bool SeaRobScheduler::AddInput(SeaRobObject *obj) {
+	if (s_inputCount >= SCHEDULER_MAX_INPUTS) {
+		bclogger_error("SeaRobScheduler: no room for input object %d", obj->_objId);
+		return false;
+	}
+	s_inputs[s_inputCount++] = obj;
+	return true;
+}
+
+
+/*
+ */
+void SeaRobScheduler::RemoveInput(SeaRobObject *obj) {
+	for (int i = 0 ; i < s_inputCount ; i++) {
+		if (s_inputs[i] == obj) {
+			s_inputCount--;
+			for ( ; i < s_inputCount ; i++) {
+				s_inputs[i] = s_inputs[i + 1];
+			}
+			return;
+		}
+	}
+}
+
+
+/*
+ */
+void SeaRobScheduler::Remove(SeaRobObject *obj) {
+	Cancel(obj);
+	RemoveInput(obj);
+}
+
+
+/*
+ */
+void SeaRobScheduler::Service(unsigned long now) {
+	SeaRobClock::Update(now);
+	
+	// Inputs first, so a press has immediate impact on whatever it wakes.
+	SeaRobPinChange::Dispatch();
+	SeaRobInput::Scan(now);
+	for (int i = 0 ; i < s_inputCount ; i++) {
+		s_inputs[i]->ProcessLoop(now);
+	}
+	
+	// Take everything that is due off the heap before running any of it.
+	SeaRobObject *due[SCHEDULER_MAX_TIMERS];
+	int dueCount = 0;
+	while ((s_timerCount > 0) && !IsBefore(now, s_timers[0]->_scheduledTime)) {
+		due[dueCount++] = s_timers[0];
+		RemoveAt(0);
+	}
+	
+	for (int i = 0 ; i < dueCount ; i++) {
+		due[i]->ProcessLoop(now);
+	}
+}
+
+
+/*
+ */
+void SeaRobScheduler::Place(SeaRobObject *obj, int slot) {
+	s_timers[slot] = obj;
+	obj->_timerSlot = slot;
+}
+
+
+/*
+ */
+void SeaRobScheduler::SiftUp(int slot) {
+	SeaRobObject *obj = s_timers[slot];
+	while (slot > 0) {
+		int parent = (slot - 1) / 2;
+		if (!IsBefore(obj->_scheduledTime, s_timers[parent]->_scheduledTime)) {
+			break;
+		}
+		Place(s_timers[parent], slot);
+		slot = parent;
+	}
+	Place(obj, slot);
+}
+
+
+/*
+ */
+void SeaRobScheduler::SiftDown(int slot) {
+	SeaRobObject *obj = s_timers[slot];
+	for (;;) {
+		int child = (slot * 2) + 1;
+		if (child >= s_timerCount) {
+			break;
+		}
+		if ((child + 1 < s_timerCount) && IsBefore(s_timers[child + 1]->_scheduledTime, s_timers[child]->_scheduledTime)) {
+			child++;
+		}
+		if (!IsBefore(s_timers[child]->_scheduledTime, obj->_scheduledTime)) {
+			break;
+		}
+		Place(s_timers[child], slot);
+		slot = child;
+	}
+	Place(obj, slot);
+}
+
+
+/*
+ */
+void SeaRobScheduler::RemoveAt(int slot) {
+	SeaRobObject *obj = s_timers[slot];
+	obj->_timerSlot = -1;
+	
+	s_timerCount--;
+	if (slot == s_timerCount) {
+		return;
+	}
+	
+	// Move the last entry into the hole; it may belong above or below it.
+	SeaRobObject *moved = s_timers[s_timerCount];
+	Place(moved, slot);
+	SiftUp(slot);
+	SiftDown(moved->_timerSlot);
+}
@@ -0,0 +1,59 @@
+#ifndef __searob_scheduler_h__
+#define __searob_scheduler_h__
+
+#include "Arduino.h"
+
+#define SCHEDULER_MAX_TIMERS 	48
+#define SCHEDULER_MAX_INPUTS 	48
+
+class SeaRobObject;
+
+
+/*
+ * Decides which objects get their ProcessLoop() called, so loop() does not have to walk every
+ * object on every pass. Buttons are scanned a port at a time (SeaRobInput.h), or delivered from
+ * the pin-change queue (SeaRobPinChange.h) when on an interrupt pin; any other inputs are
+ * polled on every Service(). Everything else asks for a call at a deadline and is left alone
+ * until then. The deadlines are kept in a min-heap, so the cost of a pass grows with what is
+ * due, not with how many objects there are.
+ *
+ * Objects register themselves; sketches only call Service() from loop(). Deadlines compare
+ * wrap-safe, so they must be less than ~24 days out.
+ */
+class SeaRobScheduler {
+  public:
+  		// Calls ProcessLoop() on the first Service() at or after when; moves an existing deadline.
+  		static bool		ScheduleAt(SeaRobObject *obj, unsigned long when);
+  		// Same, for the next Service().
+  		static bool		Wake(SeaRobObject *obj) { return ScheduleAt(obj, millis()); }
+  		static void		Cancel(SeaRobObject *obj);
+  		
+  		static bool		AddInput(SeaRobObject *obj);
+  		static void		RemoveInput(SeaRobObject *obj);
+  		
+  		// Drops every registration; called by the SeaRobObject destructor.
+  		static void		Remove(SeaRobObject *obj);
+  		
+  		// Takes in the inputs, then runs what is due. Something scheduled for now from inside a
+  		// ProcessLoop() waits for the next call, so one object cannot spin the loop.
+  		static void		Service(unsigned long now);
+  		
+  		static int		GetTimerCount() { return s_timerCount; }
+  		static int		GetTimerPeak() { return s_timerPeak; }
+  		static int		GetInputCount() { return s_inputCount; }
+  		
+  private:
+  		static bool		IsBefore(unsigned long a, unsigned long b) { return (int32_t) (a - b) < 0; }
+  		static void		Place(SeaRobObject *obj, int slot);
+  		static void		SiftUp(int slot);
+  		static void		SiftDown(int slot);
+  		static void		RemoveAt(int slot);
+  		
+  		static SeaRobObject *	s_timers[SCHEDULER_MAX_TIMERS];
+  		static int				s_timerCount;
+  		static int				s_timerPeak;
+  		static SeaRobObject *	s_inputs[SCHEDULER_MAX_INPUTS];
+  		static int				s_inputCount;
+};
+
+#endif // __searob_scheduler_h__
@@ -0,0 +1,79 @@
+#include "Arduino.h"
+#include "SeaRobLogger.h"
+#include "SeaRobShiftIn.h"
+#if !defined(__AVR__)
+#include "SeaRobSim.h"
+#endif
+
+
+/* static class objects (global) */
+uint8_t SeaRobShiftIn::s_registerCount = 0;
+#if defined(__AVR__)
+volatile uint8_t * SeaRobShiftIn::s_loadRegister = NULL;
+uint8_t SeaRobShiftIn::s_loadMask = 0;
+#endif
+
+
+/*
+ */
+void SeaRobShiftIn::Begin(int loadPin, int registerCount) {
+	if (registerCount > SHIFTIN_MAX_REGISTERS) {
+		bclogger_error("SeaRobShiftIn: %d registers, only %d read", registerCount, SHIFTIN_MAX_REGISTERS);
+		registerCount = SHIFTIN_MAX_REGISTERS;
+	}
+	s_registerCount = registerCount;
+
+#if defined(__AVR__)
+	pinMode(loadPin, OUTPUT);
+	digitalWrite(loadPin, HIGH);
+	s_loadRegister = portOutputRegister(digitalPinToPort(loadPin));
+	s_loadMask = digitalPinToBitMask(loadPin);
+
+	// Master, mode 0, MSB first, F_CPU / 2: the same as SeaRobShiftOut.
+	pinMode(SS, OUTPUT);
+	pinMode(SCK, OUTPUT);
+	pinMode(MOSI, OUTPUT);
+	pinMode(MISO, INPUT);
+	SPCR = _BV(SPE) | _BV(MSTR);
+	SPSR = _BV(SPI2X);
+#else
+	for (int pin = SHIFTIN_PIN_BASE ; pin < SHIFTIN_PIN_BASE + 8 * s_registerCount ; pin++) {
+		SeaRobSim::SetPinMode(pin, INPUT_PULLUP);
+	}
+#endif
+
+	bclogger("SeaRobShiftIn: %d registers, load=%d, pins %d-%d",
+		s_registerCount, loadPin, SHIFTIN_PIN_BASE, SHIFTIN_PIN_BASE + 8 * s_registerCount - 1);
+}
+
+
+/*
+ * A low pulse on SH/LD latches every input at once; then the register on the board comes
+ * out first, H to A.
+ */
+void SeaRobShiftIn::Load(uint8_t *image) {
+#if defined(__AVR__)
+	// Interrupt code may own other bits of the load pin's port.
+	noInterrupts();
+	*s_loadRegister &= ~s_loadMask;
+	*s_loadRegister |= s_loadMask;
+	interrupts();
+
+	for (uint8_t reg = 0 ; reg < s_registerCount ; reg++) {
+		SPDR = 0;
+		while (!(SPSR & _BV(SPIF))) {
+		}
+		image[reg] = SPDR;
+	}
+#else
+	for (uint8_t reg = 0 ; reg < s_registerCount ; reg++) {
+		uint8_t bits = 0;
+		for (uint8_t bit = 0 ; bit < 8 ; bit++) {
+			if (SeaRobSim::ReadDigital(SHIFTIN_PIN_BASE + 8 * reg + bit)) {
+				bits |= 1 << bit;
+			}
+		}
+		image[reg] = bits;
+	}
+#endif
+}
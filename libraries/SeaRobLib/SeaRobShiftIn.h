@@ -0,0 +1,52 @@
+#ifndef __searob_shiftin_h__
+#define __searob_shiftin_h__
+
+#include "Arduino.h"
+#include "SeaRobShiftOut.h"
+
+// Virtual input pins: SHIFTIN_PIN_BASE + 8 * register + input (A-H), register 0 being the one
+// wired to the board. Just after the SeaRobShiftOut pins.
+#ifndef SHIFTIN_PIN_BASE
+#define SHIFTIN_PIN_BASE 			(SHIFTOUT_PIN_BASE + 8 * SHIFTOUT_MAX_REGISTERS)
+#endif
+#ifndef SHIFTIN_MAX_REGISTERS
+#define SHIFTIN_MAX_REGISTERS 		16
+#endif
+
+
+/*
+ * Input expansion through a daisy chain of 74HC165 parallel-load shift registers on the
+ * hardware SPI port: the first register's QH to MISO (50), SCK (52) to every CLK, CLK INH
+ * tied low, and a load pin of the sketch's choosing to every SH/LD. The 165 never lets go of
+ * MISO, so it cannot share the bus with SPI devices that talk back; a SeaRobShiftOut chain
+ * is fine, since the 595s only listen.
+ *
+ * Each register is a port of SeaRobInput: buttons attach to virtual pins, and every scan
+ * loads the whole chain and reads it in one burst, about a microsecond per register at 8MHz,
+ * to be debounced eight bits at a time with the real ports.
+ *
+ * In the simulator each input is read from its virtual pin on the simulated board; Begin()
+ * gives them pull-ups, as the resistors on a button panel would.
+ */
+class SeaRobShiftIn {
+  public:
+  		// Sets up SPI and the load pin for a chain of registerCount registers.
+  		static void		Begin(int loadPin, int registerCount);
+
+  		static bool		IsVirtual(int pin) {
+  		  return (pin >= SHIFTIN_PIN_BASE) && (pin < SHIFTIN_PIN_BASE + 8 * SHIFTIN_MAX_REGISTERS);
+  		}
+  		static int		GetRegisterCount() { return s_registerCount; }
+
+  		// Called by SeaRobInput::Scan(); fills an image byte per register.
+  		static void		Load(uint8_t *image);
+
+  private:
+  		static uint8_t				s_registerCount;
+#if defined(__AVR__)
+  		static volatile uint8_t *	s_loadRegister;
+  		static uint8_t				s_loadMask;
+#endif
+};
+
+#endif // __searob_shiftin_h__
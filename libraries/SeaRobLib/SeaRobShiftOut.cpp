@@ -0,0 +1,72 @@
+#include "Arduino.h"
+#include "SeaRobLogger.h"
+#include "SeaRobShiftOut.h"
+#if !defined(__AVR__)
+#include "SeaRobSim.h"
+#endif
+
+
+/* static class objects (global) */
+uint8_t SeaRobShiftOut::s_registerCount = 0;
+#if defined(__AVR__)
+volatile uint8_t * SeaRobShiftOut::s_latchRegister = NULL;
+uint8_t SeaRobShiftOut::s_latchMask = 0;
+#endif
+
+
+/*
+ */
+void SeaRobShiftOut::Begin(int latchPin, int registerCount) {
+	if (registerCount > SHIFTOUT_MAX_REGISTERS) {
+		bclogger_error("SeaRobShiftOut: %d registers, only %d driven", registerCount, SHIFTOUT_MAX_REGISTERS);
+		registerCount = SHIFTOUT_MAX_REGISTERS;
+	}
+	s_registerCount = registerCount;
+
+#if defined(__AVR__)
+	pinMode(latchPin, OUTPUT);
+	digitalWrite(latchPin, LOW);
+	s_latchRegister = portOutputRegister(digitalPinToPort(latchPin));
+	s_latchMask = digitalPinToBitMask(latchPin);
+
+	// Master, mode 0, MSB first, F_CPU / 2.
+	pinMode(SS, OUTPUT);
+	pinMode(SCK, OUTPUT);
+	pinMode(MOSI, OUTPUT);
+	SPCR = _BV(SPE) | _BV(MSTR);
+	SPSR = _BV(SPI2X);
+#endif
+
+	uint8_t dark[SHIFTOUT_MAX_REGISTERS] = { 0 };
+	Shift(dark);
+
+	bclogger("SeaRobShiftOut: %d registers, latch=%d, pins %d-%d",
+		s_registerCount, latchPin, SHIFTOUT_PIN_BASE, SHIFTOUT_PIN_BASE + 8 * s_registerCount - 1);
+}
+
+
+/*
+ * The far end of the chain goes first; each register passes on what it held as the next
+ * byte comes in.
+ */
+void SeaRobShiftOut::Shift(const uint8_t *image) {
+#if defined(__AVR__)
+	for (int8_t reg = s_registerCount - 1 ; reg >= 0 ; reg--) {
+		SPDR = image[reg];
+		while (!(SPSR & _BV(SPIF))) {
+		}
+	}
+
+	// Interrupt code may own other bits of the latch's port.
+	noInterrupts();
+	*s_latchRegister |= s_latchMask;
+	*s_latchRegister &= ~s_latchMask;
+	interrupts();
+#else
+	for (uint8_t reg = 0 ; reg < s_registerCount ; reg++) {
+		for (uint8_t bit = 0 ; bit < 8 ; bit++) {
+			SeaRobSim::WritePin(SHIFTOUT_PIN_BASE + 8 * reg + bit, (image[reg] >> bit) & 1, SeaRobSim::Digital);
+		}
+	}
+#endif
+}
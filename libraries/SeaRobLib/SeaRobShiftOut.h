@@ -0,0 +1,52 @@
+#ifndef __searob_shiftout_h__
+#define __searob_shiftout_h__
+
+#include "Arduino.h"
+
+// Virtual pins: SHIFTOUT_PIN_BASE + 8 * register + output (Q0-Q7), register 0 being the one
+// wired to the board. Just above the Mega's pins, and below those of SeaRobShiftIn, SeaRobExpander
+// and SeaRobPixels. They run past 255: keep them in an int (or uint16_t), never hand one to the
+// Arduino core, whose pin functions take a uint8_t.
+#ifndef SHIFTOUT_PIN_BASE
+#define SHIFTOUT_PIN_BASE 			72
+#endif
+#ifndef SHIFTOUT_MAX_REGISTERS
+#define SHIFTOUT_MAX_REGISTERS 		32
+#endif
+
+
+/*
+ * Output expansion through a daisy chain of 74HC595 shift registers on the hardware SPI port:
+ * MOSI (51) to the first register's SER, SCK (52) to every SRCLK, and a latch pin of the
+ * sketch's choosing to every RCLK. SS (53) is kept an output, as SPI master mode requires,
+ * and MISO (50) is taken by the SPI port, so none of the four is free for lights.
+ *
+ * Each register is a port of SeaRobOutput: lights attach to virtual pins and write into its
+ * shadow images like any other on/off output, and Commit() has the whole chain shifted out
+ * in one burst, only when a bit changed. At 8MHz that is about a microsecond per register.
+ * Virtual pins cannot dim; a dimmable SeaRobLight on one is on/off.
+ *
+ * In the simulator each output is written to its virtual pin on the simulated board instead.
+ */
+class SeaRobShiftOut {
+  public:
+  		// Sets up SPI and the latch pin for a chain of registerCount registers, all outputs low.
+  		static void		Begin(int latchPin, int registerCount);
+
+  		static bool		IsVirtual(int pin) {
+  		  return (pin >= SHIFTOUT_PIN_BASE) && (pin < SHIFTOUT_PIN_BASE + 8 * SHIFTOUT_MAX_REGISTERS);
+  		}
+  		static int		GetRegisterCount() { return s_registerCount; }
+
+  		// Called by SeaRobOutput::Commit(), with an image byte per register.
+  		static void		Shift(const uint8_t *image);
+
+  private:
+  		static uint8_t				s_registerCount;
+#if defined(__AVR__)
+  		static volatile uint8_t *	s_latchRegister;
+  		static uint8_t				s_latchMask;
+#endif
+};
+
+#endif // __searob_shiftout_h__
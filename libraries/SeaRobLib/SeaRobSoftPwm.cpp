@@ -0,0 +1,172 @@
+#include "Arduino.h"
+#include "SeaRobSoftPwm.h"
+#include "SeaRobLogger.h"
+
+
+/* static class objects (global) */
+SeaRobSoftPwm::Channel SeaRobSoftPwm::s_channels[SOFTPWM_MAX_CHANNELS];
+uint8_t SeaRobSoftPwm::s_channelCount = 0;
+bool SeaRobSoftPwm::s_dirty = false;
+volatile uint8_t * SeaRobSoftPwm::s_portRegisters[SOFTPWM_MAX_PORTS];
+uint8_t SeaRobSoftPwm::s_portOwned[SOFTPWM_MAX_PORTS];
+volatile uint8_t SeaRobSoftPwm::s_portCount = 0;
+uint8_t SeaRobSoftPwm::s_images[2][SOFTPWM_BITS][SOFTPWM_MAX_PORTS];
+volatile uint8_t SeaRobSoftPwm::s_front = 0;
+volatile bool SeaRobSoftPwm::s_swapPending = false;
+volatile uint8_t SeaRobSoftPwm::s_slot = 0;
+
+
+#if defined(__AVR__)
+ISR(TIMER1_COMPA_vect) {
+	SeaRobSoftPwm::HandleInterrupt();
+}
+#endif
+
+
+/*
+ */
+int SeaRobSoftPwm::Attach(int pin) {
+	if (s_channelCount >= SOFTPWM_MAX_CHANNELS) {
+		bclogger_error("SeaRobSoftPwm: no room for pin %d", pin);
+		return -1;
+	}
+	
+#if defined(__AVR__)
+	volatile uint8_t *reg = portOutputRegister(digitalPinToPort(pin));
+	uint8_t mask = digitalPinToBitMask(pin);
+#else
+	volatile uint8_t *reg = NULL;
+	uint8_t mask = 1;
+#endif
+
+	uint8_t port = 0;
+	while ((port < s_portCount) && (s_portRegisters[port] != reg)) {
+		port++;
+	}
+	if (port == SOFTPWM_MAX_PORTS) {
+		bclogger_error("SeaRobSoftPwm: no room for the port of pin %d", pin);
+		return -1;
+	}
+	
+	// digitalWrite() also takes the pin off its hardware PWM timer.
+	pinMode(pin, OUTPUT);
+	digitalWrite(pin, LOW);
+	
+	noInterrupts();
+	if (port == s_portCount) {
+		s_portRegisters[port] = reg;
+		s_portOwned[port] = 0;
+		s_portCount = port + 1;
+	}
+	s_portOwned[port] |= mask;
+	interrupts();
+	
+	int channel = s_channelCount++;
+	s_channels[channel].pin = pin;
+	s_channels[channel].port = port;
+	s_channels[channel].mask = mask;
+	s_channels[channel].level = 0;
+	s_channels[channel].committed = 0;
+	
+	if (channel == 0) {
+		StartTimer();
+	}
+	return channel;
+}
+
+
+/*
+ */
+void SeaRobSoftPwm::Set(int channel, uint8_t level) {
+	if ((channel < 0) || (channel >= s_channelCount) || (s_channels[channel].level == level)) {
+		return;
+	}
+	s_channels[channel].level = level;
+	s_dirty = true;
+}
+
+
+#if defined(__AVR__)
+
+/*
+ * Rebuilds the back buffer; if the ISR has not taken the last one yet, tries again next loop.
+ */
+void SeaRobSoftPwm::Commit() {
+	if (!s_dirty || s_swapPending) {
+		return;
+	}
+	s_dirty = false;
+	
+	uint8_t back = s_front ^ 1;
+	memset(s_images[back], 0, sizeof(s_images[back]));
+	for (uint8_t c = 0 ; c < s_channelCount ; c++) {
+		Channel *channel = &s_channels[c];
+		uint8_t level = channel->level >> (8 - SOFTPWM_BITS);
+		for (uint8_t bit = 0 ; level ; bit++, level >>= 1) {
+			if (level & 1) {
+				s_images[back][bit][channel->port] |= channel->mask;
+			}
+		}
+		channel->committed = channel->level;
+	}
+	s_swapPending = true;
+}
+
+
+/*
+ * CTC mode on OCR1A, with no output pins; HandleInterrupt() moves OCR1A on each slot.
+ */
+void SeaRobSoftPwm::StartTimer() {
+	noInterrupts();
+	TCCR1A = 0;
+	TCCR1B = _BV(WGM12) | _BV(CS11); // CTC, clk/8
+	TCNT1 = 0;
+	OCR1A = SOFTPWM_BASE_TICKS - 1;
+	TIMSK1 |= _BV(OCIE1A);
+	interrupts();
+}
+
+
+/*
+ */
+void SeaRobSoftPwm::HandleInterrupt() {
+	uint8_t slot = s_slot;
+	if ((slot == 0) && s_swapPending) {
+		s_front ^= 1;
+		s_swapPending = false;
+	}
+	
+	const uint8_t *images = s_images[s_front][slot];
+	for (uint8_t port = 0 ; port < s_portCount ; port++) {
+		volatile uint8_t *reg = s_portRegisters[port];
+		*reg = (*reg & ~s_portOwned[port]) | images[port];
+	}
+	
+	OCR1A = (SOFTPWM_BASE_TICKS << slot) - 1;
+	s_slot = (slot + 1 == SOFTPWM_BITS) ? 0 : (slot + 1);
+}
+
+#else
+
+void SeaRobSoftPwm::Commit() {
+	if (!s_dirty) {
+		return;
+	}
+	s_dirty = false;
+	
+	for (uint8_t c = 0 ; c < s_channelCount ; c++) {
+		Channel *channel = &s_channels[c];
+		if (channel->level != channel->committed) {
+			channel->committed = channel->level;
+			analogWrite(channel->pin, channel->level);
+		}
+	}
+}
+
+void SeaRobSoftPwm::StartTimer() {
+}
+
+void SeaRobSoftPwm::HandleInterrupt() {
+}
+
+#endif // __AVR__
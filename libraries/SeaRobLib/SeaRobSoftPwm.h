@@ -0,0 +1,73 @@
+#ifndef __searob_softpwm_h__
+#define __searob_softpwm_h__
+
+#include "Arduino.h"
+
+// Compile-time sizing; the SRAM cost is about 3 bytes per channel plus 2 per bit per port.
+#ifndef SOFTPWM_MAX_CHANNELS
+#define SOFTPWM_MAX_CHANNELS 	32
+#endif
+#ifndef SOFTPWM_MAX_PORTS
+#define SOFTPWM_MAX_PORTS 		6
+#endif
+#ifndef SOFTPWM_BITS
+#define SOFTPWM_BITS 			6 // levels are 0-255 in, 2^bits steps out; at most 8
+#endif
+#ifndef SOFTPWM_FRAME_HZ
+#define SOFTPWM_FRAME_HZ 		200
+#endif
+
+// Timer1 runs at F_CPU / 8; the shortest slot lasts this many of its ticks.
+#define SOFTPWM_BASE_TICKS 		(F_CPU / 8UL / SOFTPWM_FRAME_HZ / ((1UL << SOFTPWM_BITS) - 1))
+
+
+/*
+ * Software PWM on any digital pin, by bit-angle modulation. A frame has one slot per bit of
+ * resolution, slot n lasting twice as long as slot n-1; in slot n a pin is high if bit n of
+ * its level is set. The Timer1 ISR only writes one precomputed image per port per slot, so
+ * it costs the same for 1 channel as for 32, and fires SOFTPWM_BITS times per frame.
+ *
+ * Levels set from the main loop take effect at the next Commit(), which rebuilds the images
+ * into a back buffer that the ISR swaps in at the start of a frame.
+ *
+ * Owns Timer1: pins 11 and 12 lose hardware PWM, and it cannot be used with Servo. In the
+ * simulator Commit() hands each changed level to analogWrite() instead.
+ */
+class SeaRobSoftPwm {
+  public:
+  		// Returns the channel, or -1 when full or unsupported. The pin starts dark.
+  		static int		Attach(int pin);
+  		static void		Set(int channel, uint8_t level);
+  		static void		Commit();
+  		static int		GetChannelCount() { return s_channelCount; }
+  		
+  		// Called by the Timer1 ISR only.
+  		static void		HandleInterrupt();
+  		
+  private:
+  		typedef struct {
+  		  uint8_t				pin;
+  		  uint8_t				port; // index into the port tables below
+  		  uint8_t				mask;
+  		  uint8_t				level;
+  		  uint8_t				committed;
+  		} Channel;
+  		
+  		static void		StartTimer();
+  		
+  		static Channel			s_channels[SOFTPWM_MAX_CHANNELS];
+  		static uint8_t			s_channelCount;
+  		static bool				s_dirty;
+  		
+  		static volatile uint8_t *	s_portRegisters[SOFTPWM_MAX_PORTS];
+  		static uint8_t			s_portOwned[SOFTPWM_MAX_PORTS];
+  		static volatile uint8_t	s_portCount;
+  		
+  		// Per buffer, per slot, per port: the bits to drive high.
+  		static uint8_t			s_images[2][SOFTPWM_BITS][SOFTPWM_MAX_PORTS];
+  		static volatile uint8_t	s_front;
+  		static volatile bool	s_swapPending;
+  		static volatile uint8_t	s_slot;
+};
+
+#endif // __searob_softpwm_h__
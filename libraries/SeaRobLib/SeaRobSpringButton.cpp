@@ -1,52 +1,114 @@
 #include "Arduino.h"
+#include "SeaRobInput.h"
 #include "SeaRobLogger.h"
+#include "SeaRobPinChange.h"
+#include "SeaRobScheduler.h"
 #include "SeaRobSpringButton.h"
 	  
 
 /*
  */
-SeaRobSpringButton::SeaRobSpringButton(String name, int pin, bool useInternalPullUp, 
+SeaRobSpringButton::SeaRobSpringButton(const __FlashStringHelper *name, int pin, bool useInternalPullUp, 
 		onButtonAction downHandler, onButtonAction upHandler, void *opaque) 
-			: _name(name), _pin(pin), _downHandler(downHandler), _upHandler(upHandler), _opaque(opaque) {
+			: _name(name), _pin(pin), _downHandler(downHandler), _upHandler(upHandler), _opaque(opaque),
+				_debounceMillis(SPRINGBUTTON_DEBOUNCE_MILLIS), _levelChangeTime(0), _inputHandle(-1), _pinChangeHandle(-1) {
 	
 	_downLevel = useInternalPullUp ? LOW : HIGH;
 	_levelPrev = useInternalPullUp ? HIGH : LOW;
-	pinMode(_pin, useInternalPullUp ? INPUT_PULLUP : INPUT);
+	SeaRobInput::PinMode(_pin, useInternalPullUp ? INPUT_PULLUP : INPUT);
+	_inputHandle = SeaRobInput::Attach(_pin, _levelPrev, StaticOnPinChange, this);
+	if ((_inputHandle < 0) && !SeaRobInput::IsVirtual(_pin)) {
+		SeaRobScheduler::AddInput(this);
+	}
 	
-	bclogger("SeaRobSpringButton [%d:%s] started on pin %d, internal-pullup=%d", 
-		_objId, _name.c_str(), _pin, useInternalPullUp);
+	bclogger("SeaRobSpringButton [%d:%S] started on pin %d, internal-pullup=%d", 
+		_objId, _name, _pin, useInternalPullUp);
 } 
 
 
 /*
  */
+SeaRobSpringButton::~SeaRobSpringButton() {
+	SeaRobInput::Detach(_inputHandle);
+	SeaRobPinChange::Detach(_pinChangeHandle);
+}
+
+
+/*
+ */
+bool SeaRobSpringButton::EnablePinChange() {
+	if (_pinChangeHandle >= 0) {
+		return true;
+	}
+	if (SeaRobInput::IsVirtual(_pin)) {
+		return false;
+	}
+	
+	_pinChangeHandle = SeaRobPinChange::Attach(_pin, _debounceMillis, StaticOnPinChange, this);
+	if (_pinChangeHandle < 0) {
+		bclogger("SeaRobSpringButton [%d:%S] no pin-change interrupt on pin %d, still polling", 
+			_objId, _name, _pin);
+		return false;
+	}
+	
+	SeaRobInput::Detach(_inputHandle);
+	_inputHandle = -1;
+	SeaRobScheduler::RemoveInput(this);
+	return true;
+}
+
+
+/*
+ * Polls the pin on its own, when SeaRobInput had no room for it or by hand.
+ */
 void SeaRobSpringButton::ProcessLoop(unsigned long updateTime) {
+	if (SeaRobInput::IsVirtual(_pin)) {
+		return; // only SeaRobInput reads the chain or the expander
+	}
 
 	// Light Button Control: Detect if the voltage level on the button has changed.
 	int currRead = digitalRead(_pin);   
 	if (currRead == _levelPrev) {
-		// bclogger("SeaRobSpringButton [%d:%s] level on pin %d is still the same (%d)", 
-		//	_objId, _name.c_str(), _pin, currRead);
+		// bclogger("SeaRobSpringButton [%d:%S] level on pin %d is still the same (%d)", 
+		//	_objId, _name, _pin, currRead);
+		return;
+	}
+	
+	// Still bouncing from the last change; look again on a later pass.
+	if ((updateTime - _levelChangeTime) < _debounceMillis) {
+		return;
+	}
+	
+	HandleLevel(currRead, updateTime);
+}
+
+
+/*
+ * Level after debouncing, from polling or from the pin-change queue.
+ */
+void SeaRobSpringButton::HandleLevel(int currRead, unsigned long updateTime) {
+	if (currRead == _levelPrev) {
 		return;
 	}
 	
-	bclogger("SeaRobSpringButton [%d:%s] level on pin %d CHANGE (%d -> %d)", 
-		_objId, _name.c_str(), _pin, _levelPrev, currRead);
+	bclogger_debug("SeaRobSpringButton [%d:%S] level on pin %d CHANGE (%d -> %d)", 
+		_objId, _name, _pin, _levelPrev, currRead);
 	
 	// A transition just happened; lets figure out which type it is, and ripple the event up.
 	if (currRead == _downLevel) {
-		bclogger("SeaRobSpringButton [%d:%s] triggered buttonDown on pin %d", 
-			_objId, _name.c_str(), _pin);
+		bclogger_debug("SeaRobSpringButton [%d:%S] triggered buttonDown on pin %d", 
+			_objId, _name, _pin);
 		if (_downHandler) {
 			_downHandler(this, updateTime);
 		}
 	} else {
-		bclogger("SeaRobSpringButton [%d:%s] triggered buttonUp on pin %d", 
-			_objId, _name.c_str(), _pin);
+		bclogger_debug("SeaRobSpringButton [%d:%S] triggered buttonUp on pin %d", 
+			_objId, _name, _pin);
 		if (_upHandler) {
 			_upHandler(this, updateTime);
 		}
 	}
 
   	_levelPrev = currRead;
+  	_levelChangeTime = updateTime;
 } 
@@ -1,8 +1,12 @@
 #ifndef __searob_springbutton_h__
 #define __searob_springbutton_h__
 
+#include "Arduino.h"
 #include "SeaRobObject.h"
 
+// Level changes closer together than this are contact bounce.
+#define SPRINGBUTTON_DEBOUNCE_MILLIS 	20
+
 /*
 	Callback prototype for events triggered by the detected button press.
 */
@@ -14,17 +18,37 @@ typedef void (*onButtonAction) (SeaRobSpringButton *button, long updateTime);
 	Represents one physical button; when pressed, the onPressDown callback is invoked. 
 	The physical button pops back up with a spring when released.
 	Requires one input pin per button.
+	Scanned with the rest of its port by SeaRobInput by default (polled on its own when
+	SeaRobInput is full); EnablePinChange() moves it onto a pin-change interrupt instead,
+	on pins that have one (see SeaRobPinChange.h). SetDebounce() is for the pin-change and
+	polled paths; SeaRobInput debounces every pin alike. The pin may be a virtual one on a
+	SeaRobShiftIn chain, where the pull-ups are the panel's own resistors, or on a
+	SeaRobExpander chip, which has pull-ups of its own.
 */
 class SeaRobSpringButton : public SeaRobObject {
   public:
-  				SeaRobSpringButton(String name, int pin, bool useInternalPullUp,
+  				SeaRobSpringButton(const __FlashStringHelper *name, int pin, bool useInternalPullUp,
   							onButtonAction downHandler, onButtonAction upHandler = NULL, void *opaque = NULL);
   				
+  				virtual ~SeaRobSpringButton();
+  				
   		virtual void 	ProcessLoop(unsigned long updateTime);
   		void * 			GetOpaque() { return _opaque; }
+  		const __FlashStringHelper *	GetName() { return _name; }
+  		
+  		void			SetDebounce(unsigned int debounceMillis) { _debounceMillis = debounceMillis; }
+  		// False when the pin has no pin-change interrupt; the button then stays polled.
+  		bool			EnablePinChange();
+  		
+  protected:
+  		void			HandleLevel(int level, unsigned long updateTime);
+  		
+  		static void		StaticOnPinChange(void *opaque, int level, unsigned long edgeTime) {
+  		  ((SeaRobSpringButton *) opaque)->HandleLevel(level, edgeTime);
+  		}
   		
   private:
-		const String          	_name;
+		const __FlashStringHelper *	_name; // PROGMEM
 		const int             	_pin;
 		 
 		const onButtonAction   	_downHandler;
@@ -33,6 +57,11 @@ class SeaRobSpringButton : public SeaRobObject {
 		
 		int             		_levelPrev;
 		int						_downLevel;
+		
+		unsigned int			_debounceMillis;
+		unsigned long			_levelChangeTime;
+		int						_inputHandle;
+		int						_pinChangeHandle;
 };
 
 
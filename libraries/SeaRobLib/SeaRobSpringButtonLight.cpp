@@ -5,42 +5,38 @@
 
 /*
  */
-SeaRobSpringButtonLight::SeaRobSpringButtonLight(String name, int buttonPin, int ledPin, 
+SeaRobSpringButtonLight::SeaRobSpringButtonLight(const __FlashStringHelper *name, int buttonPin, int ledPin, 
 		bool dimmable, bool useInternalPullUp,
 		onStateChange downHandler, onStateChange upHandler, void *opaque) 
 		: _name(name), _button(NULL), _dimmable(dimmable),
 			_downHandler(downHandler), _upHandler(upHandler), _opaque(opaque), 
-			_light(NULL), _extraLightLen(0), _extraLightCapacity(0), _extraLights(NULL)  {
+			_extraLightLen(0)  {
 	
 	// Setup the optional light.
 	if (ledPin >= 0) {	
-		_light = new SeaRobLight(ledPin, _dimmable);
+		_light.Attach(ledPin, _dimmable);
 	}
 	
 	// Setup the button.
-	char buttonName[255];
-	snprintf(buttonName, 255, "%s button", _name.c_str());
-	_button = new SeaRobSpringButton(buttonName, buttonPin, useInternalPullUp,
+	_button = new SeaRobSpringButton(_name, buttonPin, useInternalPullUp,
 		SeaRobSpringButtonLight::StaticOnButtonDown, SeaRobSpringButtonLight::StaticOnButtonUp, this);
 	
-	bclogger("SeaRobSpringButtonLight [%d:%s] created on button-pin %d and light-pin %d", 
-		_objId, _name.c_str(), buttonPin, ledPin);
+	bclogger("SeaRobSpringButtonLight [%d:%S] created on button-pin %d and light-pin %d", 
+		_objId, _name, buttonPin, ledPin);
 }
 
 
 /*
 */
 SeaRobSpringButtonLight::~SeaRobSpringButtonLight() {
-	bclogger("SeaRobSpringButtonLight [%d:%s] destroying", 
-		_objId, _name.c_str());
+	bclogger("SeaRobSpringButtonLight [%d:%S] destroying", 
+		_objId, _name);
 	
 	for (int i = 0 ; i < _extraLightLen ; i++) {
-		delete _extraLights[i];
-		_extraLights[i] = NULL;
+		_extraLights[i].Release();
 	}
-	delete[] _extraLights;
 	
-	delete _light;
+	_light.Release();
 	delete _button;
 }
 
@@ -49,22 +45,13 @@ SeaRobSpringButtonLight::~SeaRobSpringButtonLight() {
 */
 void SeaRobSpringButtonLight::AddExtraLedPin(int ledPin) {
 
-	if (_extraLightLen == _extraLightCapacity) {
-		int newCapacity = (_extraLightCapacity == 0) ? 16 : (_extraLightCapacity * 2);
-		SeaRobLight ** newExtraLights = new SeaRobLight *[newCapacity];
-		for (int i = 0 ; i < _extraLightLen ; i++) {
-			newExtraLights[i] = _extraLights[i];
-		}
-		for (int i = _extraLightLen ; i < newCapacity ; i++) {
-			newExtraLights[i] = NULL;
-		}
-		
-		delete[] _extraLights;
-		_extraLightCapacity = newCapacity;
-		_extraLights = newExtraLights;
+	if (_extraLightLen == SPRINGBUTTONLIGHT_MAX_EXTRA_LIGHTS) {
+		bclogger_error("SeaRobSpringButtonLight [%d:%S] no room for extra light-pin %d", 
+			_objId, _name, ledPin);
+		return;
 	}
 	
-	_extraLights[_extraLightLen] = new SeaRobLight(ledPin, _dimmable);
+	_extraLights[_extraLightLen].Attach(ledPin, _dimmable);
 	_extraLightLen++;
 }
 
@@ -72,15 +59,13 @@ void SeaRobSpringButtonLight::AddExtraLedPin(int ledPin) {
 /*
  */
 void SeaRobSpringButtonLight::OnButtonDown(long updateTime) {  
-	if (_light) {
-		_light->ToggleOnOff();
-	}
+	_light.ToggleOnOff();
 	for (int i = 0 ; i < _extraLightLen ; i++) {
-		_extraLights[i]->ToggleOnOff();
+		_extraLights[i].ToggleOnOff();
 	}
 	
-	bclogger("SeaRobSpringButtonLight buttondown [%d:%s] toggled to %s", 
-		_objId, _name.c_str(), _light->IsOn() ? "on" : "off");
+	bclogger("SeaRobSpringButtonLight buttondown [%d:%S] toggled to %s", 
+		_objId, _name, _light.IsOn() ? "on" : "off");
 	if (_downHandler) {
 		_downHandler(this, updateTime);
 	}
@@ -90,8 +75,8 @@ void SeaRobSpringButtonLight::OnButtonDown(long updateTime) {
 /*
  */
 void SeaRobSpringButtonLight::OnButtonUp(long updateTime) {  
-	bclogger("SeaRobSpringButtonLight buttonup [%d:%s] currently set to %s", 
-		_objId, _name.c_str(), _light->IsOn() ? "on" : "off");
+	bclogger("SeaRobSpringButtonLight buttonup [%d:%S] currently set to %s", 
+		_objId, _name, _light.IsOn() ? "on" : "off");
 	if (_upHandler) {
 		_upHandler(this, updateTime);
 	}
@@ -99,15 +84,8 @@ void SeaRobSpringButtonLight::OnButtonUp(long updateTime) {
 
 
 /*
+ * Only needed when polling by hand; the lights are always run by SeaRobScheduler.
  */
 void SeaRobSpringButtonLight::ProcessLoop(unsigned long updateTime) {
-	// Always process button first (which could change our state if it were toggled).
 	_button->ProcessLoop(updateTime);
-	
-	if (_light) {
-		_light->ProcessLoop(updateTime);
-	}
-	for (int i = 0 ; i < _extraLightLen ; i++) {
-		_extraLights[i]->ProcessLoop(updateTime);
-	}
 }
\ No newline at end of file
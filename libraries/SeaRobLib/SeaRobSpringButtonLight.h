@@ -2,9 +2,11 @@
 #define __searob_springbuttonlight_h__
 
 #include "SeaRobSpringButton.h"
-#include "SeaRobLight.h"
+#include "SeaRobLightBank.h"
 #include "SeaRobObject.h"
 
+#define SPRINGBUTTONLIGHT_MAX_EXTRA_LIGHTS 	4
+
 
 /*
 	Callback prototype for events triggered by the detected button press.
@@ -19,7 +21,7 @@ typedef void (*onStateChange) (SeaRobSpringButtonLight *bl, long updateTime);
 class SeaRobSpringButtonLight : public SeaRobObject {
 
   public:
-    		SeaRobSpringButtonLight(String name, int buttonPin, int ledPin, 
+    		SeaRobSpringButtonLight(const __FlashStringHelper *name, int buttonPin, int ledPin, 
     				bool dimmable, bool useInternalPullUp,
     				onStateChange downHandler, onStateChange upHandler = NULL, void *opaque = NULL);
     		virtual ~SeaRobSpringButtonLight();
@@ -29,30 +31,29 @@ class SeaRobSpringButtonLight : public SeaRobObject {
     void					AddExtraLedPin(int ledPin);
     
     SeaRobSpringButton * 	GetButton() { return _button; }
-    SeaRobLight *  			GetLight() { return _light; }
+    SeaRobLightHandle *		GetLight() { return &_light; }
    	int  					GetExtraLightLen() { return _extraLightLen; }
-    SeaRobLight **	  		GetExtraLights() { return _extraLights; }
+    SeaRobLightHandle *		GetExtraLights() { return _extraLights; }
     
-    bool 					IsOn() { return _light->IsOn(); }
+    bool 					IsOn() { return _light.IsOn(); }
     void *					GetOpaque() { return _opaque; }
-    String					GetName() { return _name; }
+    const __FlashStringHelper *	GetName() { return _name; }
 
   protected:
     void 					OnButtonDown(long updateTime);
     void 					OnButtonUp(long updateTime);
 
   private:
-    const String                _name;
+    const __FlashStringHelper * _name; // PROGMEM, shared with the button
     const SeaRobSpringButton *  _button;
     const bool					_dimmable;
     const onStateChange    	  	_downHandler;
     const onStateChange    	  	_upHandler;
     const void *          		_opaque;
     
-    const SeaRobLight *         _light;
+    SeaRobLightHandle			_light; // not valid without a led pin
     int							_extraLightLen;
-    int							_extraLightCapacity;
-    SeaRobLight **         		_extraLights;
+    SeaRobLightHandle    		_extraLights[SPRINGBUTTONLIGHT_MAX_EXTRA_LIGHTS];
     
   protected:
 	static void StaticOnButtonDown(SeaRobSpringButton *button, long updateTime) {
@@ -1,57 +1,149 @@
 #include "Arduino.h"
+#include "SeaRobClock.h"
 #include "SeaRobLogger.h"
+#include "SeaRobScheduler.h"
 #include "SeaRobSpringButtonLightList.h"
 
 
 /*
+ * The blink modes, compiled into flash by SeaRobPattern.h. Frame is the frame number within
+ * the pattern, light the light's position in the list. A new mode is a struct here, a row
+ * in blinkPatterns and a BlinkState.
  */
-SeaRobSpringButtonLightList::SeaRobSpringButtonLightList(String name, int numLights, int* buttonPins, int* lightPins, 
+struct OffPattern {
+	enum { FrameMillis = 0 };
+	static constexpr int Frames(int /*numLights*/) { return 1; }
+	static constexpr bool Lit(int /*numLights*/, int /*light*/, int /*frame*/) { return false; }
+};
+
+struct ConstantOnPattern {
+	enum { FrameMillis = 0 };
+	static constexpr int Frames(int /*numLights*/) { return 1; }
+	static constexpr bool Lit(int /*numLights*/, int /*light*/, int /*frame*/) { return true; }
+};
+
+// All together: 500ms on, 1000ms off.
+struct SyncBlinkShortPattern {
+	enum { FrameMillis = 500 };
+	static constexpr int Frames(int /*numLights*/) { return 3; }
+	static constexpr bool Lit(int /*numLights*/, int /*light*/, int frame) { return frame == 0; }
+};
+
+// All together: 1500ms on, 500ms off.
+struct SyncBlinkLongPattern {
+	enum { FrameMillis = 500 };
+	static constexpr int Frames(int /*numLights*/) { return 4; }
+	static constexpr bool Lit(int /*numLights*/, int /*light*/, int frame) { return frame < 3; }
+};
+
+// One light at a time, each lit for the first of its 2 frames.
+struct SingleUniPattern {
+	enum { FrameMillis = 500 };
+	static constexpr int Frames(int numLights) { return numLights * 2; }
+	static constexpr bool Lit(int /*numLights*/, int light, int frame) { return frame == (light * 2); }
+};
+
+// As SingleUni, with 3 frames per light.
+struct SingleUniSlowPattern {
+	enum { FrameMillis = 500 };
+	static constexpr int Frames(int numLights) { return numLights * 3; }
+	static constexpr bool Lit(int /*numLights*/, int light, int frame) { return frame == (light * 3); }
+};
+
+// All lit but one, which is dark for the first of its 4 frames.
+struct SingleUniInversePattern {
+	enum { FrameMillis = 500 };
+	static constexpr int Frames(int numLights) { return numLights * 4; }
+	static constexpr bool Lit(int /*numLights*/, int light, int frame) { return frame != (light * 4); }
+};
+
+// One light sweeping to the end and back, lit for the first of every 2 frames; the end
+// lights are passed once per sweep, the others twice.
+struct CylonEyePattern {
+	enum { FrameMillis = 500 };
+	static constexpr int Frames(int numLights) { return (numLights > 1) ? ((numLights - 1) * 4) : 2; }
+	static constexpr int Position(int numLights, int step) { 
+		return (step < numLights) ? step : ((2 * (numLights - 1)) - step); 
+	}
+	static constexpr bool Lit(int numLights, int light, int frame) { 
+		return ((frame % 2) == 0) && (Position(numLights, frame / 2) == light); 
+	}
+};
+
+// By BlinkState, then by light count.
+static const SeaRobPattern blinkPatterns[][PATTERN_MAX_LIGHTS] PROGMEM = {
+	PATTERN_ENTRIES(OffPattern),
+	PATTERN_ENTRIES(ConstantOnPattern),
+	PATTERN_ENTRIES(SyncBlinkShortPattern),
+	PATTERN_ENTRIES(SyncBlinkLongPattern),
+	PATTERN_ENTRIES(SingleUniPattern),
+	PATTERN_ENTRIES(SingleUniSlowPattern),
+	PATTERN_ENTRIES(SingleUniInversePattern),
+	PATTERN_ENTRIES(CylonEyePattern),
+};
+
+
+/*
+ */
+SeaRobSpringButtonLightList::SeaRobSpringButtonLightList(const __FlashStringHelper *name, int numLights, int* buttonPins, int* lightPins, 
 	int selectorButtonPin, bool useInternalPullUp)
  		: _numLights(numLights), _blinkState(BlinkState::BlinkState_Off) {
+	memcpy_P(&_pattern, &blinkPatterns[_blinkState][0], sizeof(_pattern));
+	_frame = 0;
+	_nextFrame = 0;
+	_cycleStart = 0;
+	if (_numLights > PATTERN_MAX_LIGHTS) {
+		bclogger_error("SeaRobSpringButtonLightList (%d): %d lights, blink modes only drive the first %d", 
+			_objId, _numLights, PATTERN_MAX_LIGHTS);
+	}
+	
 	// Alloc the light array.
-	_buttonLights = new SeaRobSpringButtonLight*[_numLights * 2];
+	_buttonLights = (SeaRobSpringButtonLight **) SeaRobArena::Allocate(_numLights * sizeof(SeaRobSpringButtonLight *));
 
-	// Init the light+button array.
-	char buttonName[255];
+	// Init the light+button array; they share the list's name, the log tells them apart by id.
 	for (int i = 0 ; i < _numLights ; i++) {
-		snprintf(buttonName, 255, "%s %d", name.c_str(), i + 1);
-		SeaRobSpringButtonLight * bl = new SeaRobSpringButtonLight(buttonName, buttonPins[i], lightPins[i], false, true,
+		SeaRobSpringButtonLight * bl = new SeaRobSpringButtonLight(name, buttonPins[i], lightPins[i], false, true,
 				StaticOnButtonDownLightIndividual, NULL, this);
 		_buttonLights[i] = bl;
 	}
 
     // Blink-mode selector button.
-	snprintf(buttonName, 255, "%s selector", name.c_str());
-    _buttonModeSelector = new SeaRobSpringButton(buttonName, selectorButtonPin, useInternalPullUp, StaticOnButtonDownLightSelector, NULL, this);
+    _buttonModeSelector = new SeaRobSpringButton(name, selectorButtonPin, useInternalPullUp, StaticOnButtonDownLightSelector, NULL, this);
     
-    bclogger("SeaRobSpringButtonLightList (%d): created with num=%d, state=%d, selector=%d", 
-		_objId, _numLights, _blinkState, selectorButtonPin);
+    bclogger("SeaRobSpringButtonLightList (%d:%S): created with num=%d, state=%d, selector=%d", 
+		_objId, name, _numLights, _blinkState, selectorButtonPin);
 }
 
 
 /*
  */
-SeaRobSpringButtonLightList::SeaRobSpringButtonLightList(String name, int numLights, int startButtonPin, int startLightPin, 
+SeaRobSpringButtonLightList::SeaRobSpringButtonLightList(const __FlashStringHelper *name, int numLights, int startButtonPin, int startLightPin, 
 	int selectorButtonPin, bool useInternalPullUp)
  		: _numLights(numLights), _blinkState(BlinkState::BlinkState_Off) {
+	memcpy_P(&_pattern, &blinkPatterns[_blinkState][0], sizeof(_pattern));
+	_frame = 0;
+	_nextFrame = 0;
+	_cycleStart = 0;
+	if (_numLights > PATTERN_MAX_LIGHTS) {
+		bclogger_error("SeaRobSpringButtonLightList (%d): %d lights, blink modes only drive the first %d", 
+			_objId, _numLights, PATTERN_MAX_LIGHTS);
+	}
+	
 	// Alloc the light array.
-	_buttonLights = new SeaRobSpringButtonLight*[_numLights];
+	_buttonLights = (SeaRobSpringButtonLight **) SeaRobArena::Allocate(_numLights * sizeof(SeaRobSpringButtonLight *));
 
-	// Init the light+button array.
-	char buttonName[255];
+	// Init the light+button array; they share the list's name, the log tells them apart by id.
 	for (int i = 0 ; i < _numLights ; i++) {
-		snprintf(buttonName, 255, "%s button %d", name, i + 1);
-		SeaRobSpringButtonLight * bl = new SeaRobSpringButtonLight(buttonName, startButtonPin + i, startLightPin + i, false, true,
+		SeaRobSpringButtonLight * bl = new SeaRobSpringButtonLight(name, startButtonPin + i, startLightPin + i, false, true,
 			StaticOnButtonDownLightIndividual, NULL, this);
 		_buttonLights[i] = bl;
 	}
 
     // Blink-mode selector button.
-    snprintf(buttonName, 255, "%s selector", name);
-    _buttonModeSelector = new SeaRobSpringButton(buttonName, selectorButtonPin, useInternalPullUp, StaticOnButtonDownLightSelector, NULL, this);
+    _buttonModeSelector = new SeaRobSpringButton(name, selectorButtonPin, useInternalPullUp, StaticOnButtonDownLightSelector, NULL, this);
     
-	bclogger("SeaRobSpringButtonLightList (%d): created with num=%d, state=%d, button-start=%d, light-start=%d, selector=%d", 
-		_objId, _numLights, _blinkState, startButtonPin, startLightPin, selectorButtonPin);
+	bclogger("SeaRobSpringButtonLightList (%d:%S): created with num=%d, state=%d, button-start=%d, light-start=%d, selector=%d", 
+		_objId, name, _numLights, _blinkState, startButtonPin, startLightPin, selectorButtonPin);
 }
 
 
@@ -62,20 +154,50 @@ SeaRobSpringButtonLightList::~SeaRobSpringButtonLightList() {
 	for (int i = 0 ; i < _numLights ; i++) {
 		delete _buttonLights[i];
 	}
-	delete[] _buttonLights;
+	SeaRobArena::Release(_buttonLights);
 	
 	delete _buttonModeSelector;
 }
 
 
 /*
+ * Steps the blink pattern; SeaRobScheduler runs this at each frame edge (the buttons are
+ * inputs of their own).
  */
 void SeaRobSpringButtonLightList::ProcessLoop(unsigned long updateTime) {
-  	// Always process button first (which could change our state if it were toggled).
-	_buttonModeSelector->ProcessLoop(updateTime);
-    
+	if (_pattern.frameCount <= 1) {
+		return;
+	}
+	
+	if ((int32_t) (updateTime - _nextFrame) >= 0) {
+		SeekFrame(updateTime);
+		ShowFrame();
+	}
+	SeaRobScheduler::ScheduleAt(this, _nextFrame);
+}
+
+
+/*
+ * The frame the clock is at, and when the next one starts. Patterns keep SeaRobClock time, so
+ * every list in the same mode shows the same frame, and a late tick lands on the right one
+ * instead of stepping through the frames it missed.
+ */
+void SeaRobSpringButtonLightList::SeekFrame(unsigned long updateTime) {
+	uint32_t into = SeaRobClock::Elapsed(updateTime, &_cycleStart, 
+		(uint32_t) _pattern.frameCount * _pattern.frameMillis);
+	_frame = into / _pattern.frameMillis;
+	_nextFrame = updateTime + (((uint32_t) _frame + 1) * _pattern.frameMillis - into);
+}
+
+
+/*
+ */
+void SeaRobSpringButtonLightList::ShowFrame() {
+	uint8_t mask = pgm_read_byte(_pattern.frames + _frame);
 	for (int i = 0 ; i < _numLights ; i++) {
-		_buttonLights[i]->ProcessLoop(updateTime);
+		SeaRobSpringButtonLight * bl = _buttonLights[i];
+		bl->GetLight()->Show(mask & 1);
+		mask >>= 1;
 	}
 }
 
@@ -154,153 +276,27 @@ void SeaRobSpringButtonLightList::OnButtonDownLightSelector(long updateTime) {
 
 
 /*
+ * Switches to the pattern for the new state, at the frame the clock has it on.
  */
 void SeaRobSpringButtonLightList::HandleStateChange(long updateTime) {
-	switch (_blinkState) {
-	
-    case BlinkState_Off: {
-		for (int i = 0 ; i < _numLights ; i++) {
-			SeaRobSpringButtonLight * bl = _buttonLights[i];
-			bl->GetLight()->UpdateState(SeaRobLight::LightState::Off);
-		} 
-	  }
-      break;
-      
-    case BlinkState_ConstantOn: {
-		for (int i = 0 ; i < _numLights ; i++) {
-			SeaRobSpringButtonLight * bl = _buttonLights[i];
-			bl->GetLight()->UpdateState(SeaRobLight::LightState::On);
-		} 
-	  }
-      break;
-  
-	case BlinkState_SyncBlinkShort: {
-		int delay = 0;
-		int durationOn = 500;
-		int durationOff = 1000;
-		for (int i = 0 ; i < _numLights ; i++) {
-			SeaRobSpringButtonLight * bl = _buttonLights[i];
-			bl->GetLight()->UpdateBlinkConfig(updateTime, delay, durationOn, durationOff);
-			bl->GetLight()->UpdateState(SeaRobLight::LightState::UniformBlink);
-		} 
-	  }
-	  break;
-	  
-	case BlinkState_SyncBlinkLong: {
-		int delay = 0;
-		int durationOn = 1500;
-		int durationOff = 500;
-		for (int i = 0 ; i < _numLights ; i++) {
-			SeaRobSpringButtonLight * bl = _buttonLights[i];
-			bl->GetLight()->UpdateBlinkConfig(updateTime, delay, durationOn, durationOff);
-			bl->GetLight()->UpdateState(SeaRobLight::LightState::UniformBlink);
-		} 
-	  }
-	  break;
-	  
-   case BlinkState_SingleUni: {
-   		// frameTime is the duration in millis of one animation frame.
-   		// frameCount is how many frames each light gets in the sequence.
-   		// Light is on for 1 frame, then off for the rest of the frameCount (frameCount - 1).
-   		// It is also off for every other light's frames.
-		int frameTime = 500;
-		int frameCount = 2;
-		int durationOn = frameTime;
-		int durationOff = ((_numLights * frameCount) - 1) * frameTime;
-	
-		for (int i = 0 ; i < _numLights ; i++) {
-			SeaRobSpringButtonLight * bl = _buttonLights[i];
-			
-			int delay = (i * frameCount) * frameTime;
-			bl->GetLight()->UpdateBlinkConfig(updateTime, delay, durationOn, durationOff, false);
-			bl->GetLight()->UpdateState(SeaRobLight::LightState::UniformBlink);
-		} 
-	  }
-	  break;
-	  
-	case BlinkState_SingleUniSlow: {
-		int frameTime = 500;
-		int frameCount = 3;
-		int durationOn = frameTime;
-		int durationOff = ((_numLights * frameCount) - 1) * frameTime;
-	
-		for (int i = 0 ; i < _numLights ; i++) {
-			SeaRobSpringButtonLight * bl = _buttonLights[i];
-			
-			int delay = (i * frameCount) * frameTime;
-			bl->GetLight()->UpdateBlinkConfig(updateTime, delay, durationOn, durationOff, false);
-			bl->GetLight()->UpdateState(SeaRobLight::LightState::UniformBlink);
-		} 
-	  }
-	  break;
-
-    case BlinkState_SingleUniInverse: {
-		int frameTime = 500;
-		int frameCount = 4;
-		int durationOff = frameTime;
-		int durationOn = ((_numLights * frameCount) - 1) * frameTime;
+	int lights = (_numLights < PATTERN_MAX_LIGHTS) ? _numLights : PATTERN_MAX_LIGHTS;
+	if (lights == 0) {
+		// No lights added yet: no pattern to show, nor a row of the table for one.
+		SeaRobScheduler::Cancel(this);
+		return;
+	}
+	memcpy_P(&_pattern, &blinkPatterns[_blinkState][lights - 1], sizeof(_pattern));
+	_frame = 0;
 	
-		for (int i = 0 ; i < _numLights ; i++) {
-			SeaRobSpringButtonLight * bl = _buttonLights[i];
-			
-			int delay = (i * frameCount) * frameTime;
-			bl->GetLight()->UpdateBlinkConfig(updateTime, delay, durationOn, durationOff, true);
-			bl->GetLight()->UpdateState(SeaRobLight::LightState::UniformBlink);
-		} 
-	  }
-      break;
-      
-	case BlinkState_CylonEye: {
-		// frameDuration is how log one frame of animation is.
-		int frameDuration = 500;
-		// frameCount is how many frames each light gets in the animation sequence.
-		// 1 of the frames will be the light blinking on, the rest will be blanks before the next light.
-		int frameCount = 2;
-		// totalFrames = slots/frames until animation repeats; every light is repeated twice,
-		// except for the two on the ends, which only get one. The -1 is the subtraction those two halves.
-		int totalFrames = (_numLights - 1) * frameCount * 2;
+	if (_pattern.frameCount > 1) {
+		_cycleStart = SeaRobClock::CycleStart(updateTime, 0, (uint32_t) _pattern.frameCount * _pattern.frameMillis);
+		SeekFrame(updateTime);
+		ShowFrame();
+		SeaRobScheduler::ScheduleAt(this, _nextFrame);
+	} else {
+		ShowFrame();
+		SeaRobScheduler::Cancel(this);
+	}
 	
-		for (int i = 0 ; i < _numLights ; i++) {
-			SeaRobSpringButtonLight * bl = _buttonLights[i];
-			
-			int delay = (i * 2);
-			
-			if ((i == 0) || (i == (_numLights - 1))) {
-				// first and last lights only blink once per cycle
-				int durationOn = 1;
-				int durationOff = (totalFrames - 1);
-				bclogger("CylonEye setup: hitting edge case, i=%d: totalFrames=%d, delay=%d, on=%d, off=%d", 
-					i, totalFrames, delay, durationOn, durationOff);
-
-				bl->GetLight()->UpdateBlinkConfig(updateTime, (delay * frameDuration), (durationOn * frameDuration), 
-					(durationOff * frameDuration));
-				bl->GetLight()->UpdateState(SeaRobLight::LightState::UniformBlink);
-			} else {
-				int durationOn = 1;
-				
-				int distanceToEnd = _numLights - (i + 1);
-				int lightsTilBackFromEnd = (distanceToEnd * 2) - 1;
-				int firstDelayFrames = ((lightsTilBackFromEnd * frameCount) + (frameCount - 1));
-				
-				int distanceToFront = i;
-				int lightsTilBackFromFront = (distanceToFront * 2) - 1;
-				int secondDelayFrames = ((lightsTilBackFromFront * frameCount) + (frameCount - 1)); 
-				bclogger("CylonEye setup: hitting middle case, i=%d: totalFrames=%d, delay=%d, pattern=%d,%d,%d,%d", 
-					i, totalFrames, delay, durationOn, firstDelayFrames, durationOn, secondDelayFrames);
-				
-				int blinkSequence[4] = { (durationOn * frameDuration), (firstDelayFrames * frameDuration), 
-					(durationOn * frameDuration), (secondDelayFrames * frameDuration) };
-				bl->GetLight()->UpdateBlinkSequenceConfig(updateTime, (delay * frameDuration), 4, blinkSequence, false);
-				bl->GetLight()->UpdateState(SeaRobLight::LightState::UniformBlink);
-			}	
-		}  
-	  }
-	  break;
-
-    default:
-      bclogger("SeaRobSpringButtonLightList: ERROR: undefined state: %ld", _blinkState);
-      break;
-  }  
-
   bclogger("SeaRobSpringButtonLightList (%d): now state=%d", _objId, _blinkState);
 }
@@ -3,6 +3,7 @@
 
 #include "SeaRobSpringButtonLight.h"
 #include "SeaRobObject.h"
+#include "SeaRobPattern.h"
 
 
 /*
@@ -26,9 +27,9 @@ class SeaRobSpringButtonLightList :  public SeaRobObject {
 	} BlinkState;
 
   public:
-    				SeaRobSpringButtonLightList(String name, int numLights, int startButtonPin, 
+    				SeaRobSpringButtonLightList(const __FlashStringHelper *name, int numLights, int startButtonPin, 
     					int startLightPin, int selectorButtonPin, bool useInternalPullUp = true);
-    				SeaRobSpringButtonLightList(String name, int numLights, int* buttonPins, 
+    				SeaRobSpringButtonLightList(const __FlashStringHelper *name, int numLights, int* buttonPins, 
     					int* lightPins, int selectorButtonPin, bool useInternalPullUp = true);
     	virtual 	~SeaRobSpringButtonLightList();
 
@@ -39,6 +40,8 @@ class SeaRobSpringButtonLightList :  public SeaRobObject {
 	  void OnButtonDownLightSelector(long updateTime);
 	  void OnButtonDownLightIndividual(long updateTime);
 	  void HandleStateChange(long updateTime);
+	  void SeekFrame(unsigned long updateTime);
+	  void ShowFrame();
 	  
   protected:
 		static void StaticOnButtonDownLightIndividual(SeaRobSpringButtonLight *buttonLight, long updateTime) {
@@ -53,9 +56,13 @@ class SeaRobSpringButtonLightList :  public SeaRobObject {
 
   private:
   	const int							_numLights;
-  	const SeaRobSpringButtonLight **   	_buttonLights;
+  	SeaRobSpringButtonLight **   		_buttonLights;
   	const SeaRobSpringButton *        	_buttonModeSelector;
 	BlinkState      		        	_blinkState;
+	SeaRobPattern						_pattern; // of _blinkState, copied out of flash
+	uint8_t								_frame;
+	unsigned long						_nextFrame;
+	uint32_t							_cycleStart; // see SeaRobClock
 };
 
 
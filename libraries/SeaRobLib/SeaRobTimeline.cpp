@@ -0,0 +1,292 @@
+#include "Arduino.h"
+#include "SeaRobFade.h"
+#include "SeaRobLogger.h"
+#include "SeaRobScheduler.h"
+#include "SeaRobTimeline.h"
+
+
+/*
+ */
+SeaRobTimeline::SeaRobTimeline(const SeaRobKeyframe *keys, int keyCount, uint16_t duration)
+		: _keys(keys), _keyCount(keyCount), _duration(duration), _channelCount(0),
+		_playing(false), _mode(Loop), _reverse(false), _speed(TIMELINE_SPEED_ONE),
+		_position(0), _fraction(0), _lastUpdate(0) {
+	for (int c = 0 ; c < TIMELINE_MAX_CHANNELS ; c++) {
+		_trackFirst[c] = -1;
+		_trackLast[c] = -1;
+		_shown[c] = -1;
+		_target[c] = NULL;
+	}
+
+	// Find each channel's track; they must come in order.
+	int lastChannel = -1;
+	uint16_t lastTime = 0;
+	for (int k = 0 ; k < _keyCount ; k++) {
+		uint8_t channel = pgm_read_byte(&_keys[k].channel);
+		uint16_t time = pgm_read_word(&_keys[k].time);
+		if ((channel >= TIMELINE_MAX_CHANNELS) || (channel < lastChannel) ||
+				((channel == lastChannel) && (time < lastTime))) {
+			bclogger_error("SeaRobTimeline [%d] key %d (channel %d, time %u) out of order or range, ignoring the rest",
+				_objId, k, channel, time);
+			break;
+		}
+		if (_trackFirst[channel] < 0) {
+			_trackFirst[channel] = k;
+			_channelCount = channel + 1;
+		}
+		_trackLast[channel] = k;
+		lastChannel = channel;
+		lastTime = time;
+	}
+	Rewind();
+
+	bclogger("SeaRobTimeline [%d] keys=%d, channels=%d, duration=%u", _objId, _keyCount, _channelCount, _duration);
+}
+
+
+/*
+ */
+SeaRobTimeline::~SeaRobTimeline() {
+	for (int c = 0 ; c < TIMELINE_MAX_CHANNELS ; c++) {
+		_owned[c].Release();
+	}
+}
+
+
+/*
+ */
+void SeaRobTimeline::BindLight(int channel, SeaRobLightHandle *light) {
+	if ((channel < 0) || (channel >= TIMELINE_MAX_CHANNELS)) {
+		bclogger_error("SeaRobTimeline [%d] no channel %d", _objId, channel);
+		return;
+	}
+	_owned[channel].Release();
+	_target[channel] = light;
+	_shown[channel] = -1;
+}
+
+
+/*
+ */
+void SeaRobTimeline::BindPin(int channel, int pin, bool dimmable) {
+	if ((channel < 0) || (channel >= TIMELINE_MAX_CHANNELS)) {
+		bclogger_error("SeaRobTimeline [%d] no channel %d", _objId, channel);
+		return;
+	}
+	_owned[channel].Attach(pin, dimmable);
+	_target[channel] = &_owned[channel];
+	_shown[channel] = -1;
+}
+
+
+/*
+ */
+void SeaRobTimeline::Play(unsigned long startTime, PlayMode mode) {
+	_playing = true;
+	_mode = (_duration > 0) ? mode : Once;
+	_reverse = false;
+	_position = 0;
+	_fraction = 0;
+	_lastUpdate = startTime;
+	Rewind();
+	for (uint8_t c = 0 ; c < _channelCount ; c++) {
+		_shown[c] = -1;
+	}
+	SeaRobScheduler::Wake(this);
+}
+
+
+/*
+ * The lights keep whatever level they were last shown.
+ */
+void SeaRobTimeline::Stop() {
+	_playing = false;
+	SeaRobScheduler::Cancel(this);
+}
+
+
+/*
+ */
+void SeaRobTimeline::SetSpeed(uint16_t speed) {
+	_speed = (speed > 0) ? speed : 1;
+	SeaRobScheduler::Wake(this);
+}
+
+
+/*
+ */
+void SeaRobTimeline::ProcessLoop(unsigned long updateTime) {
+	if (!_playing) {
+		return;
+	}
+	if ((int32_t) (updateTime - _lastUpdate) < 0) {
+		SeaRobScheduler::ScheduleAt(this, _lastUpdate); // started in the future
+		return;
+	}
+
+	Advance(updateTime);
+	for (uint8_t c = 0 ; c < _channelCount ; c++) {
+		Evaluate(c);
+	}
+	if (!_playing) {
+		SeaRobScheduler::Cancel(this);
+		return;
+	}
+
+	// Sleep until the nearest key edge, the end of the timeline, or the next level step of an
+	// interpolating channel.
+	unsigned long next = _reverse ? ((unsigned long) _position + 1) : (_duration - _position);
+	for (uint8_t c = 0 ; c < _channelCount ; c++) {
+		if (_trackFirst[c] < 0) {
+			continue;
+		}
+		unsigned long edge = next;
+		if (_interp[c] != Step) {
+			uint16_t length = _segmentEnd[c] - _segmentStart[c];
+			edge = (length > 256) ? (length >> 8) : 1;
+		} else if (!_reverse && (_key[c] < _trackLast[c])) {
+			edge = _segmentEnd[c] - _position;
+		} else if (_reverse && (_key[c] >= _trackFirst[c])) {
+			edge = (unsigned long) (_position - _segmentStart[c]) + 1;
+		}
+		if (edge < next) {
+			next = edge;
+		}
+	}
+	SeaRobScheduler::ScheduleAt(this, updateTime + WallMillis(next));
+}
+
+
+/*
+ * Moves the playhead by the time since the last update, scaled by the speed.
+ */
+void SeaRobTimeline::Advance(unsigned long updateTime) {
+	unsigned long elapsed = updateTime - _lastUpdate;
+	_lastUpdate = updateTime;
+	if (elapsed > 0xFFFF) {
+		elapsed = 0xFFFF; // long enough to wrap any timeline; keeps the scaling in 32 bits
+	}
+	unsigned long scaled = (elapsed * _speed) + _fraction;
+	_fraction = scaled & 0xFF;
+	unsigned long delta = scaled >> 8;
+
+	switch (_mode) {
+	case Once: {
+		unsigned long position = _position + delta;
+		if (position >= _duration) {
+			position = _duration;
+			_playing = false;
+		}
+		_position = position;
+	  }
+	  break;
+
+	case Loop: {
+		unsigned long position = _position + delta;
+		if (position >= _duration) {
+			position %= _duration;
+			Rewind();
+		}
+		_position = position;
+	  }
+	  break;
+
+	case PingPong: {
+		// Phase runs 0 to twice the duration: out, then back.
+		unsigned long cycle = 2UL * _duration;
+		unsigned long phase = (_reverse ? (cycle - _position) : _position) + delta;
+		if (phase >= cycle) {
+			phase %= cycle;
+		}
+		_reverse = (phase >= _duration);
+		_position = _reverse ? (cycle - phase) : phase;
+	  }
+	  break;
+	}
+}
+
+
+/*
+ * Puts every channel back before its first key, for the start of the timeline.
+ */
+void SeaRobTimeline::Rewind() {
+	for (uint8_t c = 0 ; c < _channelCount ; c++) {
+		if (_trackFirst[c] >= 0) {
+			LoadSegment(c, _trackFirst[c] - 1);
+		}
+	}
+}
+
+
+/*
+ */
+void SeaRobTimeline::Evaluate(uint8_t channel) {
+	if (_trackFirst[channel] < 0) {
+		return;
+	}
+
+	// Usually the playhead is still inside the segment; else it is a key or two along.
+	uint16_t position = _position;
+	int key = _key[channel];
+	while ((key < _trackLast[channel]) && (position >= _segmentEnd[channel])) {
+		LoadSegment(channel, ++key);
+	}
+	while ((key >= _trackFirst[channel]) && (position < _segmentStart[channel])) {
+		LoadSegment(channel, --key);
+	}
+
+	uint8_t level = _from[channel];
+	if (_interp[channel] != Step) {
+		uint8_t progress = SeaRobFade::Progress(_rate[channel], position - _segmentStart[channel],
+			_segmentEnd[channel] - _segmentStart[channel]);
+		uint8_t curve = SeaRobFade::Level((SeaRobFade::Curve) (_interp[channel] - Linear), progress);
+		long diff = (int) _to[channel] - (int) _from[channel];
+		level = _from[channel] + ((diff * (curve + (curve >> 7))) >> 8);
+	}
+
+	if ((level != _shown[channel]) && _target[channel]) {
+		_shown[channel] = level;
+		_target[channel]->ShowLevel(level);
+	}
+}
+
+
+/*
+ * Caches the segment starting at key (or before the track, or after it) out of flash.
+ */
+void SeaRobTimeline::LoadSegment(uint8_t channel, int key) {
+	int first = _trackFirst[channel];
+	int last = _trackLast[channel];
+	_key[channel] = key;
+	_interp[channel] = Step;
+
+	if (key < first) {
+		_segmentStart[channel] = 0;
+		_segmentEnd[channel] = pgm_read_word(&_keys[first].time);
+		_from[channel] = pgm_read_byte(&_keys[first].level);
+	} else if (key >= last) {
+		_segmentStart[channel] = pgm_read_word(&_keys[last].time);
+		_segmentEnd[channel] = 0xFFFF;
+		_from[channel] = pgm_read_byte(&_keys[last].level);
+	} else {
+		_segmentStart[channel] = pgm_read_word(&_keys[key].time);
+		_segmentEnd[channel] = pgm_read_word(&_keys[key + 1].time);
+		_from[channel] = pgm_read_byte(&_keys[key].level);
+		_to[channel] = pgm_read_byte(&_keys[key + 1].level);
+		uint16_t length = _segmentEnd[channel] - _segmentStart[channel];
+		if (length > 0) {
+			_interp[channel] = pgm_read_byte(&_keys[key].interp);
+			_rate[channel] = SeaRobFade::Rate(length);
+		}
+	}
+}
+
+
+/*
+ * Wall-clock millis until the playhead has moved timelineMillis, at least 1.
+ */
+unsigned long SeaRobTimeline::WallMillis(unsigned long timelineMillis) {
+	unsigned long scaled = (timelineMillis << 8) - _fraction;
+	unsigned long wall = (scaled + _speed - 1) / _speed;
+	return (wall > 0) ? wall : 1;
+}
@@ -0,0 +1,105 @@
+#ifndef __searob_timeline_h__
+#define __searob_timeline_h__
+
+#include "SeaRobLightBank.h"
+#include "SeaRobObject.h"
+
+#ifndef TIMELINE_MAX_CHANNELS
+#define TIMELINE_MAX_CHANNELS 	16
+#endif
+
+// Playback speed is 8.8 fixed point.
+#define TIMELINE_SPEED_ONE 		256
+
+
+/*
+ * One key of a channel's track: from this time on, the channel heads for the next key's level,
+ * the way interp says (SeaRobTimeline::Interp).
+ */
+typedef struct {
+  uint16_t		time; // millis from the start of the timeline
+  uint8_t		channel;
+  uint8_t		level; // 0-255
+  uint8_t		interp;
+} SeaRobKeyframe;
+
+
+/*
+ * Plays keyframe tracks kept in flash onto lights, one playhead for every channel. The keys
+ * are sorted by channel, then time; a channel holds its first key's level before it, and its
+ * last key's after.
+ *
+ * Each channel keeps its current segment (the pair of keys around the playhead) in SRAM, so a
+ * tick only reads flash when a channel crosses a key, and only writes a light when its level
+ * changed. Between keys a step segment costs nothing: the scheduler wakes the timeline at the
+ * next key edge, or about once per level step while something is interpolating.
+ */
+class SeaRobTimeline : public SeaRobObject {
+  public:
+  	typedef enum {
+  	  Step = 0, // hold the level until the next key
+  	  Linear, // the rest follow SeaRobFade::Curve
+  	  Gamma,
+  	  EaseInOut,
+  	  Exponential,
+  	} Interp;
+
+  	typedef enum {
+  	  Once = 0, // stop at the end, holding the last levels
+  	  Loop,
+  	  PingPong, // to the end and back again
+  	} PlayMode;
+
+  public:
+  					SeaRobTimeline(const SeaRobKeyframe *keys, int keyCount, uint16_t duration);
+  			virtual	~SeaRobTimeline();
+
+  		// A channel drives a light someone else owns, or one of its own on the pin.
+  		void		BindLight(int channel, SeaRobLightHandle *light);
+  		void		BindPin(int channel, int pin, bool dimmable);
+
+  		void		Play(unsigned long startTime, PlayMode mode = Loop);
+  		void		Stop();
+  		void		SetSpeed(uint16_t speed); // TIMELINE_SPEED_ONE is real time
+
+  		bool		IsPlaying() { return _playing; }
+  		uint16_t	GetPosition() { return _position; }
+
+  		virtual void	ProcessLoop(unsigned long updateTime);
+
+  private:
+  		void		Advance(unsigned long updateTime);
+  		void		Rewind();
+  		void		Evaluate(uint8_t channel);
+  		void		LoadSegment(uint8_t channel, int key);
+  		unsigned long	WallMillis(unsigned long timelineMillis);
+
+  		const SeaRobKeyframe *	_keys; // PROGMEM
+  		const int				_keyCount;
+  		const uint16_t			_duration;
+  		uint8_t					_channelCount;
+
+  		bool				_playing;
+  		PlayMode			_mode;
+  		bool				_reverse; // PingPong on its way back
+  		uint16_t			_speed;
+  		uint16_t			_position;
+  		uint8_t				_fraction; // of a milli, left over from the speed scaling
+  		unsigned long		_lastUpdate;
+
+  		// Per channel: its track, the segment under the playhead, and what was last shown.
+  		int					_trackFirst[TIMELINE_MAX_CHANNELS];
+  		int					_trackLast[TIMELINE_MAX_CHANNELS];
+  		int					_key[TIMELINE_MAX_CHANNELS]; // _trackFirst - 1 before the first key
+  		uint16_t			_segmentStart[TIMELINE_MAX_CHANNELS];
+  		uint16_t			_segmentEnd[TIMELINE_MAX_CHANNELS];
+  		uint8_t				_from[TIMELINE_MAX_CHANNELS];
+  		uint8_t				_to[TIMELINE_MAX_CHANNELS];
+  		uint8_t				_interp[TIMELINE_MAX_CHANNELS];
+  		unsigned long		_rate[TIMELINE_MAX_CHANNELS]; // see SeaRobFade::Rate()
+  		int					_shown[TIMELINE_MAX_CHANNELS]; // or -1
+  		SeaRobLightHandle *	_target[TIMELINE_MAX_CHANNELS];
+  		SeaRobLightHandle	_owned[TIMELINE_MAX_CHANNELS]; // for BindPin
+};
+
+#endif // __searob_timeline_h__
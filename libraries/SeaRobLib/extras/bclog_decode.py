@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""
+Turns the binary bclogger stream (SEAROB_LOG_BINARY=1 in SeaRobLogger.h) back into text.
+
+The format strings are not on the wire, only a 16-bit hash of each one, so the decoder scans
+the sketch and library sources for the bclogger calls to build the id -> format table. Point
+--src at the same tree the board was built from.
+
+  bclog_decode.py --src . capture.bin
+  bclog_decode.py --src . --port /dev/ttyACM0 --baud 9600     (needs pyserial)
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+SYNC = 0xA5
+HEADER_SIZE = 8
+
+# Formats the logger emits on its own, not through a bclogger call.
+BUILTIN_FORMATS = [
+	"bclogger: dropped %lu lines",
+]
+
+SOURCE_EXTENSIONS = (".c", ".cpp", ".h", ".ino")
+CALL_RE = re.compile(r'\bbclogger(?:_debug|_error)?\s*\(\s*((?:"(?:[^"\\]|\\.)*"\s*)+)')
+LITERAL_RE = re.compile(r'"((?:[^"\\]|\\.)*)"')
+SPEC_RE = re.compile(r'%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l)?([diouxXcfeEgGsS%])')
+ESCAPES = {"n": "\n", "r": "\r", "t": "\t", "\\": "\\", "\"": "\"", "'": "'", "0": "\0"}
+
+
+def format_id(fmt):
+	"""Same FNV-1a, folded to 16 bits, as BCLOG_ID() in SeaRobLogger.h."""
+	h = 2166136261
+	for b in fmt.encode("latin-1"):
+		h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+	return (h ^ (h >> 16)) & 0xFFFF
+
+
+def unescape(literal):
+	return re.sub(r'\\(.)', lambda m: ESCAPES.get(m.group(1), m.group(1)), literal)
+
+
+def load_formats(roots):
+	formats = {}
+	def add(fmt, where):
+		fid = format_id(fmt)
+		if fid in formats and formats[fid] != fmt:
+			sys.stderr.write("bclog_decode: id 0x%04x collides: %r (%s) and %r\n" % (fid, fmt, where, formats[fid]))
+		formats[fid] = fmt
+
+	for fmt in BUILTIN_FORMATS:
+		add(fmt, "builtin")
+	for root in roots:
+		for dirpath, dirnames, filenames in os.walk(root):
+			dirnames[:] = [d for d in dirnames if not d.startswith(".")]
+			for filename in filenames:
+				if not filename.endswith(SOURCE_EXTENSIONS):
+					continue
+				path = os.path.join(dirpath, filename)
+				with open(path, encoding="latin-1") as f:
+					text = f.read()
+				for m in CALL_RE.finditer(text):
+					fmt = "".join(unescape(lit) for lit in LITERAL_RE.findall(m.group(1)))
+					add(fmt, path)
+	return formats
+
+
+class Payload:
+	def __init__(self, data):
+		self.data = data
+		self.pos = 0
+
+	def take(self, size):
+		if self.pos + size > len(self.data):
+			raise EOFError()
+		chunk = self.data[self.pos:self.pos + size]
+		self.pos += size
+		return chunk
+
+	def integer(self, size, signed):
+		return int.from_bytes(self.take(size), "little", signed=signed)
+
+
+def render(fmt, payload):
+	"""printf the format with the arguments pulled from the payload, as the MCU would have."""
+	out = []
+	last = 0
+	for m in SPEC_RE.finditer(fmt):
+		out.append(fmt[last:m.start()])
+		last = m.end()
+		flags, width, precision, length, conv = m.groups()
+		if conv == "%":
+			out.append("%")
+			continue
+		try:
+			if width == "*":
+				width = str(payload.integer(2, True))
+			if precision == "*":
+				precision = str(payload.integer(2, True))
+			spec = "%" + flags + (width or "") + ("." + precision if precision is not None else "")
+			size = 4 if length in ("l", "ll") else 2
+			if conv in "di":
+				out.append((spec + "d") % payload.integer(size, True))
+			elif conv in "ouxX":
+				out.append((spec + conv) % payload.integer(size, False))
+			elif conv == "c":
+				out.append((spec + "c") % (payload.integer(size, False) & 0xFF))
+			elif conv in "feEgG":
+				out.append((spec + conv) % struct.unpack("<f", payload.take(4))[0])
+			else:
+				n = payload.take(1)[0]
+				out.append((spec + "s") % payload.take(n).decode("latin-1"))
+		except EOFError:
+			out.append("<truncated>")
+			return "".join(out)
+	out.append(fmt[last:])
+	return "".join(out)
+
+
+def decode(stream, formats, out):
+	buf = bytearray()
+	while True:
+		chunk = stream.read(1) if hasattr(stream, "in_waiting") else stream.read(4096)
+		if not chunk:
+			break
+		buf += chunk
+		while True:
+			start = buf.find(bytes([SYNC]))
+			if start < 0:
+				buf.clear()
+				break
+			del buf[:start]
+			if len(buf) < HEADER_SIZE or len(buf) < HEADER_SIZE + buf[1]:
+				break
+			length = buf[1]
+			fid, millis = struct.unpack_from("<HI", buf, 2)
+			payload = bytes(buf[HEADER_SIZE:HEADER_SIZE + length])
+			del buf[:HEADER_SIZE + length]
+			fmt = formats.get(fid)
+			if fmt is None:
+				text = "<unknown format 0x%04x, %d payload bytes>" % (fid, length)
+			else:
+				text = render(fmt, Payload(payload))
+			out.write("%10lu.%03lu %s\n" % (millis // 1000, millis % 1000, text))
+			out.flush()
+
+
+def main():
+	parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+	parser.add_argument("--src", action="append", help="source tree to scan for formats (repeatable; default .)")
+	parser.add_argument("--port", help="serial port to read from instead of a file")
+	parser.add_argument("--baud", type=int, default=9600)
+	parser.add_argument("input", nargs="?", help="captured stream; default stdin")
+	args = parser.parse_args()
+
+	formats = load_formats(args.src or ["."])
+	if args.port:
+		import serial
+		stream = serial.Serial(args.port, args.baud)
+	elif args.input:
+		stream = open(args.input, "rb")
+	else:
+		stream = sys.stdin.buffer
+	try:
+		decode(stream, formats, sys.stdout)
+	except KeyboardInterrupt:
+		pass
+
+
+if __name__ == "__main__":
+	main()
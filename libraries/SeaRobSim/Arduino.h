@@ -0,0 +1,160 @@
+#ifndef __searob_sim_arduino_h__
+#define __searob_sim_arduino_h__
+
+/*
+ * Host-side stand-in for the Arduino core, just enough of it to build SeaRobLib and the sketch
+ * modules on a PC. Time only moves when the simulator advances it, and every pin access goes
+ * through the simulated board in SeaRobSim.h.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+#define ARDUINO 10808
+
+typedef bool boolean;
+typedef uint8_t byte;
+typedef uint16_t word;
+
+#define HIGH 			0x1
+#define LOW  			0x0
+
+#define INPUT 			0x0
+#define OUTPUT 			0x1
+#define INPUT_PULLUP 	0x2
+
+// Arduino Mega 2560 pin count; analog pins follow the digital ones.
+#define NUM_DIGITAL_PINS 	70
+#define NUM_ANALOG_INPUTS 	16
+#define A0	54
+#define A1	55
+#define A2	56
+#define A3	57
+#define A4	58
+#define A5	59
+#define A6	60
+#define A7	61
+#define A8	62
+#define A9	63
+#define A10	64
+#define A11	65
+#define A12	66
+#define A13	67
+#define A14	68
+#define A15	69
+
+#define digitalPinHasPWM(p)		((((p) >= 2) && ((p) <= 13)) || (((p) >= 44) && ((p) <= 46)))
+
+// Flash and RAM are the same thing on the host.
+#define PROGMEM
+#define PSTR(s) 					(s)
+#define pgm_read_byte(addr) 		(*(const uint8_t *)(addr))
+#define pgm_read_word(addr) 		(*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) 		(*(const uint32_t *)(addr))
+#define pgm_read_ptr(addr) 			(*(void * const *)(addr))
+#define strlen_P					strlen
+#define strncpy_P					strncpy
+#define strcmp_P					strcmp
+#define memcpy_P					memcpy
+// avr-libc's %S (a string in flash) is %s here; these rewrite the format to say so.
+int vsnprintf_P(char *buf, size_t size, const char *fmt_P, va_list args);
+int snprintf_P(char *buf, size_t size, const char *fmt_P, ...);
+
+class __FlashStringHelper;
+#define FPSTR(s) 	(reinterpret_cast<const __FlashStringHelper *>(s))
+#define F(s) 		FPSTR(PSTR(s))
+
+// No interrupts on the host; critical sections are free.
+#define noInterrupts()
+#define interrupts()
+#define cli()
+#define sei()
+
+// Time, driven by the simulator's virtual clock.
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// Pins, backed by the simulated board.
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+void analogWrite(uint8_t pin, int val);
+int analogRead(uint8_t pin);
+
+
+/*
+ * Minimal Arduino String, on top of std::string.
+ */
+class String {
+  public:
+  					String(const char *cstr = "") : _str(cstr ? cstr : "") {}
+  					String(const String &other) : _str(other._str) {}
+  		explicit	String(const __FlashStringHelper *fstr) : _str(reinterpret_cast<const char *>(fstr)) {}
+  		explicit	String(int value) : _str(std::to_string(value)) {}
+  		explicit	String(unsigned long value) : _str(std::to_string(value)) {}
+  					
+  		String &	operator=(const String &other) { _str = other._str; return *this; }
+  		String &	operator=(const char *cstr) { _str = cstr ? cstr : ""; return *this; }
+  		String &	operator+=(const String &other) { _str += other._str; return *this; }
+  		String &	operator+=(const char *cstr) { _str += cstr; return *this; }
+  		String &	operator+=(char c) { _str += c; return *this; }
+  		bool		operator==(const String &other) const { return _str == other._str; }
+  		bool		operator==(const char *cstr) const { return _str == cstr; }
+  		bool		operator!=(const String &other) const { return _str != other._str; }
+  		
+  		const char *	c_str() const { return _str.c_str(); }
+  		unsigned int	length() const { return _str.length(); }
+  		
+  private:
+  		std::string		_str;
+};
+
+
+/*
+ * Print and the serial port. What is written to Serial is captured by the simulator.
+ */
+class Print {
+  public:
+  		virtual 		~Print() {}
+  		virtual size_t	write(uint8_t c) = 0;
+  		virtual size_t	write(const uint8_t *buf, size_t len);
+  		size_t			write(const char *str) { return str ? write((const uint8_t *) str, strlen(str)) : 0; }
+  		
+  		size_t			print(const char *str) { return write(str); }
+  		size_t			print(const __FlashStringHelper *str) { return write(reinterpret_cast<const char *>(str)); }
+  		size_t			print(const String &str) { return write(str.c_str()); }
+  		size_t			print(char c) { return write((uint8_t) c); }
+  		size_t			print(int value) { return print((long) value); }
+  		size_t			print(unsigned int value) { return print((unsigned long) value); }
+  		size_t			print(long value);
+  		size_t			print(unsigned long value);
+  		size_t			println() { return write("\r\n"); }
+  		template <typename T>
+  		size_t			println(T value) { size_t n = print(value); return n + println(); }
+};
+
+class HardwareSerial : public Print {
+  public:
+  		void			begin(unsigned long baud);
+  		void			end() {}
+  		int				available();
+  		int				read();
+  		int				peek();
+  		int				availableForWrite();
+  		void			flush() {}
+  		virtual size_t	write(uint8_t c);
+  		using Print::write;
+  					
+  		operator		bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif // __searob_sim_arduino_h__
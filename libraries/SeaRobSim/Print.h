@@ -0,0 +1,7 @@
+#ifndef __searob_sim_print_h__
+#define __searob_sim_print_h__
+
+// Print lives in the simulated Arduino.h; this is for libraries that include it by name.
+#include "Arduino.h"
+
+#endif // __searob_sim_print_h__
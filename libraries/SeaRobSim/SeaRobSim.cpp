@@ -0,0 +1,793 @@
+#include "Arduino.h"
+#include "SeaRobSim.h"
+#include "Wire.h"
+#include <algorithm>
+#include <chrono>
+
+
+/*
+ * State of the simulated board.
+ */
+#define SIM_PIN_COUNT 1024 // virtual pins too, not just the Mega's 70
+
+namespace {
+
+typedef struct {
+  unsigned long long	timeMicros;
+  int					pin;
+  int					value;
+  bool					analog;
+} ScriptedInput;
+
+// MCP23017 registers, IOCON.BANK = 0.
+#define MCP_REGISTERS 	0x16
+#define MCP_IODIRA 		0x00
+#define MCP_GPINTENA 	0x04
+#define MCP_DEFVALA 	0x06
+#define MCP_INTCONA 	0x08
+#define MCP_IOCON 		0x0A
+#define MCP_GPPUA 		0x0C
+#define MCP_INTFA 		0x0E
+#define MCP_INTCAPA 	0x10
+#define MCP_GPIOA 		0x12
+#define MCP_OLATA 		0x14
+#define MCP_IOCON_SEQOP 0x20
+
+typedef struct {
+  uint8_t				address;
+  int					firstPin;
+  int					intPin;
+  uint8_t				reg[MCP_REGISTERS];
+  uint8_t				pointer;
+  uint8_t				captured[2]; // GPIO as last read; INT compares against it
+} SimMcp23017;
+
+// WS2812 datasheet timing, in picoseconds: each high time +-150ns, each low time as well.
+#define WS2812_T0H 		400000ULL
+#define WS2812_T1H 		800000ULL
+#define WS2812_T0L 		850000ULL
+#define WS2812_T1L 		450000ULL
+#define WS2812_SLACK 	150000ULL
+#define WS2812_RESET 	50000000ULL
+
+typedef struct {
+  int					pin;
+  int					pixelCount;
+  std::vector<uint8_t>	incoming; // green, red, blue, as the first pixel passes them on
+  std::vector<uint8_t>	latched;
+  uint8_t				byte;
+  uint8_t				bits;
+  unsigned long long	lastEdge; // end of the last pulse, in picoseconds
+  unsigned long			frames;
+  unsigned long			errors;
+} SimWs2812;
+
+struct SimBoard {
+  unsigned long long				nowMicros;
+  
+  int								pinMode[SIM_PIN_COUNT];
+  int								pinValue[SIM_PIN_COUNT];
+  unsigned long						writeCount[SIM_PIN_COUNT];
+  int								digitalInput[SIM_PIN_COUNT];
+  bool								digitalInputSet[SIM_PIN_COUNT];
+  int								analogInput[SIM_PIN_COUNT];
+  
+  bool								recording;
+  std::vector<SeaRobSim::PinEvent>	events;
+  std::vector<ScriptedInput>		script;
+  
+  std::vector<SimMcp23017>			mcps;
+  unsigned long						i2cTransactions;
+  unsigned long long				i2cNanos;
+  unsigned long long				i2cCarryNanos; // not yet a whole microsecond of the clock
+  
+  std::vector<SimWs2812>			ws2812s;
+  unsigned long long				pulseCarryPicos;
+  
+  bool								serialEcho;
+  std::string						serialOut;
+  std::string						serialIn;
+};
+
+SimBoard board;
+
+bool validPin(int pin) {
+  return (pin >= 0) && (pin < SIM_PIN_COUNT);
+}
+
+bool scriptEarlier(const ScriptedInput &a, const ScriptedInput &b) {
+  return a.timeMicros < b.timeMicros;
+}
+
+/*
+ * Apply every scripted input whose time has come.
+ */
+void applyScript() {
+  size_t applied = 0;
+  while ((applied < board.script.size()) && (board.script[applied].timeMicros <= board.nowMicros)) {
+    const ScriptedInput &in = board.script[applied];
+    if (in.analog) {
+      board.analogInput[in.pin] = in.value;
+    } else {
+      board.digitalInput[in.pin] = in.value;
+      board.digitalInputSet[in.pin] = true;
+    }
+    applied++;
+  }
+  if (applied > 0) {
+    board.script.erase(board.script.begin(), board.script.begin() + applied);
+  }
+}
+
+void schedule(unsigned long long atMillis, int pin, int value, bool analog) {
+  if (!validPin(pin)) {
+    return;
+  }
+  ScriptedInput in = { atMillis * 1000ULL, pin, value, analog };
+  board.script.insert(std::upper_bound(board.script.begin(), board.script.end(), in, scriptEarlier), in);
+  applyScript();
+}
+
+/*
+ * The address and every byte after it are nine bits on the wire, the acknowledge included;
+ * start (or a repeated start) and stop take about one each.
+ */
+void i2cTime(int bytes, uint32_t clock, bool stop) {
+  unsigned long long nanos = (9ULL * (bytes + 1) + 2ULL) * 1000000000ULL / clock;
+  board.i2cNanos += nanos;
+  board.i2cCarryNanos += nanos;
+  if (stop) {
+    board.i2cTransactions++;
+  }
+  SeaRobSim::AdvanceMicros(board.i2cCarryNanos / 1000ULL);
+  board.i2cCarryNanos %= 1000ULL;
+}
+
+SimMcp23017 *findMcp(uint8_t address) {
+  for (size_t i = 0 ; i < board.mcps.size() ; i++) {
+    if (board.mcps[i].address == address) {
+      return &board.mcps[i];
+    }
+  }
+  return NULL;
+}
+
+/*
+ * The pins as the registers set them up: directions and pull-ups, and the latched outputs.
+ */
+void mcpPins(SimMcp23017 *mcp) {
+  for (int i = 0 ; i < 16 ; i++) {
+    int pin = mcp->firstPin + i;
+    if (!validPin(pin)) {
+      continue;
+    }
+    int half = i / 8;
+    uint8_t mask = 1 << (i % 8);
+    if (mcp->reg[MCP_IODIRA + half] & mask) {
+      board.pinMode[pin] = (mcp->reg[MCP_GPPUA + half] & mask) ? INPUT_PULLUP : INPUT;
+      continue;
+    }
+    board.pinMode[pin] = OUTPUT;
+    int level = (mcp->reg[MCP_OLATA + half] & mask) ? HIGH : LOW;
+    if (board.pinValue[pin] != level) {
+      SeaRobSim::WritePin(pin, level, SeaRobSim::Digital);
+    }
+  }
+}
+
+uint8_t mcpPort(SimMcp23017 *mcp, int half) {
+  uint8_t bits = 0;
+  for (int i = 0 ; i < 8 ; i++) {
+    if (SeaRobSim::ReadDigital(mcp->firstPin + 8 * half + i)) {
+      bits |= 1 << i;
+    }
+  }
+  return bits;
+}
+
+/*
+ * INT is low while an enabled input differs from its reference: DEFVAL, or with INTCON clear,
+ * the level last read from GPIO.
+ */
+bool mcpInterrupt(SimMcp23017 *mcp) {
+  for (int half = 0 ; half < 2 ; half++) {
+    uint8_t intcon = mcp->reg[MCP_INTCONA + half];
+    uint8_t reference = (mcp->reg[MCP_DEFVALA + half] & intcon) | (mcp->captured[half] & ~intcon);
+    uint8_t enabled = mcp->reg[MCP_GPINTENA + half] & mcp->reg[MCP_IODIRA + half];
+    if ((mcpPort(mcp, half) ^ reference) & enabled) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void mcpStep(SimMcp23017 *mcp) {
+  if (!(mcp->reg[MCP_IOCON] & MCP_IOCON_SEQOP)) {
+    mcp->pointer = (mcp->pointer + 1) % MCP_REGISTERS;
+  }
+}
+
+uint8_t mcpRead(SimMcp23017 *mcp) {
+  uint8_t reg = mcp->pointer;
+  uint8_t value = mcp->reg[reg];
+  if ((reg & ~1) == MCP_GPIOA) {
+    value = mcpPort(mcp, reg & 1);
+    mcp->captured[reg & 1] = value;
+  } else if ((reg & ~1) == MCP_INTCAPA) {
+    value = mcp->captured[reg & 1];
+  } else if ((reg & ~1) == MCP_INTFA) {
+    value = 0; // flags are not latched; see mcpInterrupt()
+  }
+  mcpStep(mcp);
+  return value;
+}
+
+void mcpWrite(SimMcp23017 *mcp, uint8_t value) {
+  uint8_t reg = mcp->pointer;
+  if ((reg & ~1) == MCP_IOCON) {
+    mcp->reg[MCP_IOCON] = value;
+    mcp->reg[MCP_IOCON + 1] = value;
+  } else if ((reg & ~1) == MCP_GPIOA) {
+    mcp->reg[MCP_OLATA + (reg & 1)] = value;
+  } else if (((reg & ~1) != MCP_INTFA) && ((reg & ~1) != MCP_INTCAPA)) {
+    mcp->reg[reg] = value;
+  }
+  mcpStep(mcp);
+}
+
+unsigned long long nowPicos() {
+  return board.nowMicros * 1000000ULL + board.pulseCarryPicos;
+}
+
+SimWs2812 *findWs2812(int pin) {
+  for (size_t i = 0 ; i < board.ws2812s.size() ; i++) {
+    if (board.ws2812s[i].pin == pin) {
+      return &board.ws2812s[i];
+    }
+  }
+  return NULL;
+}
+
+/*
+ * A frame is whatever arrived before the line went quiet; a pixel that got less keeps its colour.
+ */
+void ws2812Latch(SimWs2812 *strip) {
+  if (strip->incoming.empty() || (nowPicos() - strip->lastEdge < WS2812_RESET)) {
+    return;
+  }
+  std::copy(strip->incoming.begin(), strip->incoming.end(), strip->latched.begin());
+  strip->incoming.clear();
+  strip->bits = 0;
+  strip->frames++;
+}
+
+bool within(unsigned long long picos, unsigned long long nominal) {
+  return (picos + WS2812_SLACK >= nominal) && (picos <= nominal + WS2812_SLACK);
+}
+
+void ws2812Bit(SimWs2812 *strip, unsigned long highPicos, unsigned long lowPicos) {
+  ws2812Latch(strip);
+  
+  bool one = within(highPicos, WS2812_T1H) && within(lowPicos, WS2812_T1L);
+  bool zero = within(highPicos, WS2812_T0H) && within(lowPicos, WS2812_T0L);
+  if (!one && !zero) {
+    strip->errors++;
+    one = highPicos >= (WS2812_T0H + WS2812_T1H) / 2;
+  }
+  strip->byte = (strip->byte << 1) | (one ? 1 : 0);
+  if (++strip->bits < 8) {
+    return;
+  }
+  strip->bits = 0;
+  if (strip->incoming.size() < strip->latched.size()) {
+    strip->incoming.push_back(strip->byte);
+  }
+}
+
+} // namespace
+
+
+/*
+ * Arduino core functions.
+ */
+HardwareSerial Serial;
+TwoWire Wire;
+
+unsigned long millis() {
+  return (uint32_t) (board.nowMicros / 1000ULL);
+}
+
+unsigned long micros() {
+  return (uint32_t) board.nowMicros;
+}
+
+void delay(unsigned long ms) {
+  SeaRobSim::AdvanceMillis(ms);
+}
+
+void delayMicroseconds(unsigned int us) {
+  SeaRobSim::AdvanceMicros(us);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  SeaRobSim::SetPinMode(pin, mode);
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  SeaRobSim::WritePin(pin, val ? HIGH : LOW, SeaRobSim::Digital);
+}
+
+int digitalRead(uint8_t pin) {
+  return SeaRobSim::ReadDigital(pin);
+}
+
+void analogWrite(uint8_t pin, int val) {
+  if (val < 0) val = 0;
+  if (val > 255) val = 255;
+  SeaRobSim::WritePin(pin, val, SeaRobSim::Analog);
+}
+
+int analogRead(uint8_t pin) {
+  return SeaRobSim::ReadAnalog(pin);
+}
+
+/*
+ * The host's printf reads %S as a wide string; avr-libc's, as a string in flash.
+ */
+int vsnprintf_P(char *buf, size_t size, const char *fmt_P, va_list args) {
+  std::string fmt(fmt_P);
+  for (size_t i = 0 ; i < fmt.size() ; i++) {
+    if (fmt[i] != '%') {
+      continue;
+    }
+    size_t conv = fmt.find_first_not_of("-+ #0123456789.hlLjzt", i + 1);
+    if (conv == std::string::npos) {
+      break;
+    }
+    if (fmt[conv] == 'S') {
+      fmt[conv] = 's';
+    }
+    i = conv;
+  }
+  return vsnprintf(buf, size, fmt.c_str(), args);
+}
+
+int snprintf_P(char *buf, size_t size, const char *fmt_P, ...) {
+  va_list args;
+  va_start(args, fmt_P);
+  int len = vsnprintf_P(buf, size, fmt_P, args);
+  va_end(args);
+  return len;
+}
+
+
+size_t Print::write(const uint8_t *buf, size_t len) {
+  size_t n = 0;
+  while (len--) {
+    n += write(*buf++);
+  }
+  return n;
+}
+
+size_t Print::print(long value) {
+  char buf[24];
+  snprintf(buf, sizeof(buf), "%ld", value);
+  return write(buf);
+}
+
+size_t Print::print(unsigned long value) {
+  char buf[24];
+  snprintf(buf, sizeof(buf), "%lu", value);
+  return write(buf);
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+  _address = address;
+  _txLength = 0;
+  _sending = true;
+}
+
+size_t TwoWire::write(uint8_t data) {
+  if (!_sending || (_txLength >= BUFFER_LENGTH)) {
+    return 0;
+  }
+  _txBuffer[_txLength++] = data;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t quantity) {
+  size_t n = 0;
+  while ((n < quantity) && write(data[n])) {
+    n++;
+  }
+  return n;
+}
+
+uint8_t TwoWire::endTransmission(uint8_t sendStop) {
+  _sending = false;
+  return SeaRobSim::I2CWrite(_address, _txBuffer, _txLength, _clock, sendStop) ? 0 : 2;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, uint8_t sendStop) {
+  if (quantity > BUFFER_LENGTH) {
+    quantity = BUFFER_LENGTH;
+  }
+  _rxLength = SeaRobSim::I2CRead(address, _rxBuffer, quantity, _clock, sendStop);
+  _rxIndex = 0;
+  return _rxLength;
+}
+
+void HardwareSerial::begin(unsigned long) {
+}
+
+int HardwareSerial::available() {
+  return (int) board.serialIn.size();
+}
+
+int HardwareSerial::read() {
+  if (board.serialIn.empty()) {
+    return -1;
+  }
+  int c = (unsigned char) board.serialIn[0];
+  board.serialIn.erase(0, 1);
+  return c;
+}
+
+int HardwareSerial::peek() {
+  return board.serialIn.empty() ? -1 : (unsigned char) board.serialIn[0];
+}
+
+int HardwareSerial::availableForWrite() {
+  // The host never backs up.
+  return 63;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  board.serialOut += (char) c;
+  if (board.serialEcho) {
+    fputc(c, stdout);
+  }
+  return 1;
+}
+
+
+/*
+ */
+void SeaRobSim::Reset() {
+  board.nowMicros = 0;
+  for (int i = 0 ; i < SIM_PIN_COUNT ; i++) {
+    board.pinMode[i] = INPUT;
+    board.pinValue[i] = LOW;
+    board.writeCount[i] = 0;
+    board.digitalInput[i] = LOW;
+    board.digitalInputSet[i] = false;
+    board.analogInput[i] = 0;
+  }
+  board.recording = false;
+  board.events.clear();
+  board.script.clear();
+  board.mcps.clear();
+  board.ws2812s.clear();
+  board.pulseCarryPicos = 0;
+  board.i2cTransactions = 0;
+  board.i2cNanos = 0;
+  board.i2cCarryNanos = 0;
+  board.serialOut.clear();
+  board.serialIn.clear();
+}
+
+/*
+ */
+unsigned long long SeaRobSim::Now() {
+  return board.nowMicros;
+}
+
+/*
+ */
+void SeaRobSim::AdvanceMicros(unsigned long long us) {
+  board.nowMicros += us;
+  applyScript();
+}
+
+/*
+ */
+void SeaRobSim::AdvanceMillis(unsigned long long ms) {
+  AdvanceMicros(ms * 1000ULL);
+}
+
+/*
+ */
+int SeaRobSim::GetPinMode(int pin) {
+  return validPin(pin) ? board.pinMode[pin] : INPUT;
+}
+
+/*
+ */
+int SeaRobSim::GetPinValue(int pin) {
+  return validPin(pin) ? board.pinValue[pin] : LOW;
+}
+
+/*
+ */
+unsigned long SeaRobSim::GetWriteCount(int pin) {
+  return validPin(pin) ? board.writeCount[pin] : 0;
+}
+
+/*
+ */
+void SeaRobSim::SetRecording(bool enabled) {
+  board.recording = enabled;
+}
+
+/*
+ */
+void SeaRobSim::ClearEvents() {
+  board.events.clear();
+}
+
+/*
+ */
+const std::vector<SeaRobSim::PinEvent> & SeaRobSim::GetEvents() {
+  return board.events;
+}
+
+/*
+ */
+std::vector<SeaRobSim::PinEvent> SeaRobSim::GetTrace(int pin) {
+  std::vector<PinEvent> trace;
+  for (size_t i = 0 ; i < board.events.size() ; i++) {
+    if (board.events[i].pin == pin) {
+      trace.push_back(board.events[i]);
+    }
+  }
+  return trace;
+}
+
+/*
+ */
+void SeaRobSim::SetDigitalInput(int pin, int level) {
+  if (validPin(pin)) {
+    board.digitalInput[pin] = level ? HIGH : LOW;
+    board.digitalInputSet[pin] = true;
+  }
+}
+
+/*
+ */
+void SeaRobSim::SetAnalogInput(int pin, int value) {
+  if (validPin(pin)) {
+    board.analogInput[pin] = value;
+  }
+}
+
+/*
+ */
+void SeaRobSim::ScheduleDigitalInput(unsigned long long atMillis, int pin, int level) {
+  schedule(atMillis, pin, level ? HIGH : LOW, false);
+}
+
+/*
+ */
+void SeaRobSim::ScheduleAnalogInput(unsigned long long atMillis, int pin, int value) {
+  schedule(atMillis, pin, value, true);
+}
+
+/*
+ * Power-on state: every pin an input, everything else zero.
+ */
+void SeaRobSim::AttachMcp23017(uint8_t address, int firstPin, int intPin) {
+  SimMcp23017 mcp;
+  memset(&mcp, 0, sizeof(mcp));
+  mcp.address = address;
+  mcp.firstPin = firstPin;
+  mcp.intPin = intPin;
+  mcp.reg[MCP_IODIRA] = 0xFF;
+  mcp.reg[MCP_IODIRA + 1] = 0xFF;
+  board.mcps.push_back(mcp);
+  mcpPins(&board.mcps.back());
+}
+
+/*
+ */
+unsigned long SeaRobSim::GetI2CTransactions() {
+  return board.i2cTransactions;
+}
+
+/*
+ */
+unsigned long long SeaRobSim::GetI2CMicros() {
+  return board.i2cNanos / 1000ULL;
+}
+
+/*
+ */
+void SeaRobSim::AttachWs2812(int pin, int pixelCount) {
+  SimWs2812 strip;
+  strip.pin = pin;
+  strip.pixelCount = pixelCount;
+  strip.latched.assign(3 * pixelCount, 0);
+  strip.byte = 0;
+  strip.bits = 0;
+  strip.lastEdge = 0;
+  strip.frames = 0;
+  strip.errors = 0;
+  board.ws2812s.push_back(strip);
+}
+
+/*
+ */
+uint32_t SeaRobSim::GetWs2812Pixel(int pin, int pixel) {
+  SimWs2812 *strip = findWs2812(pin);
+  if ((strip == NULL) || (pixel < 0) || (pixel >= strip->pixelCount)) {
+    return 0;
+  }
+  ws2812Latch(strip);
+  const uint8_t *grb = &strip->latched[3 * pixel];
+  return ((uint32_t) grb[1] << 16) | ((uint32_t) grb[0] << 8) | grb[2];
+}
+
+/*
+ */
+unsigned long SeaRobSim::GetWs2812Frames(int pin) {
+  SimWs2812 *strip = findWs2812(pin);
+  if (strip == NULL) {
+    return 0;
+  }
+  ws2812Latch(strip);
+  return strip->frames;
+}
+
+/*
+ */
+unsigned long SeaRobSim::GetWs2812TimingErrors(int pin) {
+  SimWs2812 *strip = findWs2812(pin);
+  return strip ? strip->errors : 0;
+}
+
+/*
+ */
+void SeaRobSim::SetSerialEcho(bool echo) {
+  board.serialEcho = echo;
+}
+
+/*
+ */
+std::string & SeaRobSim::GetSerialOutput() {
+  return board.serialOut;
+}
+
+/*
+ */
+void SeaRobSim::QueueSerialInput(const char *text) {
+  board.serialIn += text;
+}
+
+/*
+ */
+SeaRobSim::RunStats SeaRobSim::Run(LoopFunction loopFn, unsigned long long durationMillis, unsigned long tickMicros) {
+  RunStats stats = { 0, 0, 0.0, 0.0 };
+  unsigned long long start = board.nowMicros;
+  unsigned long long end = start + (durationMillis * 1000ULL);
+  
+  while (board.nowMicros < end) {
+    std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+    loopFn();
+    std::chrono::steady_clock::time_point after = std::chrono::steady_clock::now();
+    
+    double nanos = std::chrono::duration<double, std::nano>(after - before).count();
+    stats.hostNanosTotal += nanos;
+    if (nanos > stats.hostNanosMax) {
+      stats.hostNanosMax = nanos;
+    }
+    stats.ticks++;
+    AdvanceMicros(tickMicros);
+  }
+  
+  stats.simMicros = board.nowMicros - start;
+  return stats;
+}
+
+/*
+ */
+void SeaRobSim::WritePin(int pin, int value, WriteKind kind) {
+  if (!validPin(pin)) {
+    return;
+  }
+  board.writeCount[pin]++;
+  if (board.pinValue[pin] == value) {
+    return;
+  }
+  
+  board.pinValue[pin] = value;
+  if (board.recording) {
+    PinEvent event = { board.nowMicros, pin, value, kind };
+    board.events.push_back(event);
+  }
+}
+
+/*
+ */
+int SeaRobSim::ReadDigital(int pin) {
+  if (!validPin(pin)) {
+    return LOW;
+  }
+  for (size_t i = 0 ; i < board.mcps.size() ; i++) {
+    // Open drain: a chip pulls the line low, or leaves it to the pull-up.
+    if ((board.mcps[i].intPin == pin) && mcpInterrupt(&board.mcps[i])) {
+      return LOW;
+    }
+  }
+  if (board.pinMode[pin] == OUTPUT) {
+    return board.pinValue[pin] ? HIGH : LOW;
+  }
+  if (!board.digitalInputSet[pin]) {
+    // Nothing driving the pin: the pull-up wins, otherwise call it low.
+    return (board.pinMode[pin] == INPUT_PULLUP) ? HIGH : LOW;
+  }
+  return board.digitalInput[pin];
+}
+
+/*
+ */
+int SeaRobSim::ReadAnalog(int pin) {
+  return validPin(pin) ? board.analogInput[pin] : 0;
+}
+
+/*
+ */
+void SeaRobSim::SetPinMode(int pin, int mode) {
+  if (validPin(pin)) {
+    board.pinMode[pin] = mode;
+  }
+}
+
+/*
+ * The line ends low, as the pin was; the clock moves on by the whole pulse.
+ */
+void SeaRobSim::Pulse(int pin, unsigned long highPicos, unsigned long lowPicos) {
+  SimWs2812 *strip = findWs2812(pin);
+  if (strip != NULL) {
+    ws2812Bit(strip, highPicos, lowPicos);
+  }
+  board.pulseCarryPicos += highPicos + lowPicos;
+  AdvanceMicros(board.pulseCarryPicos / 1000000ULL);
+  board.pulseCarryPicos %= 1000000ULL;
+  if (strip != NULL) {
+    strip->lastEdge = nowPicos();
+  }
+}
+
+/*
+ * The first byte sets the register pointer; the rest are written from there on.
+ */
+bool SeaRobSim::I2CWrite(uint8_t address, const uint8_t *data, int length, uint32_t clock, bool stop) {
+  SimMcp23017 *mcp = findMcp(address);
+  if (mcp == NULL) {
+    i2cTime(0, clock, stop);
+    return false;
+  }
+  i2cTime(length, clock, stop);
+  if (length > 0) {
+    mcp->pointer = data[0] % MCP_REGISTERS;
+    for (int i = 1 ; i < length ; i++) {
+      mcpWrite(mcp, data[i]);
+    }
+    mcpPins(mcp);
+  }
+  return true;
+}
+
+/*
+ */
+int SeaRobSim::I2CRead(uint8_t address, uint8_t *data, int length, uint32_t clock, bool stop) {
+  SimMcp23017 *mcp = findMcp(address);
+  if (mcp == NULL) {
+    i2cTime(0, clock, stop);
+    return 0;
+  }
+  i2cTime(length, clock, stop);
+  for (int i = 0 ; i < length ; i++) {
+    data[i] = mcpRead(mcp);
+  }
+  return length;
+}
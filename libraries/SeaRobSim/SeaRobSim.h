@@ -0,0 +1,103 @@
+#ifndef __searob_sim_h__
+#define __searob_sim_h__
+
+#include "Arduino.h"
+#include <vector>
+
+/*
+ * The simulated board behind the host Arduino.h: a virtual clock that only moves when told to,
+ * a record of every pin write, and scripted levels for the input pins. Lets SeaRobLib run hours
+ * of loop() in seconds, deterministically, with no hardware attached.
+ *
+ * Like the real board, millis() and micros() wrap at 32 bits. unsigned long is wider on most
+ * hosts though, so arithmetic on the returned values does not wrap the way it does on the AVR.
+ */
+class SeaRobSim {
+  public:
+  	typedef enum {
+  	  Digital = 0,
+  	  Analog,
+  	} WriteKind;
+  	
+  	// One write to an output pin; only recorded when the level actually changes.
+  	typedef struct {
+  	  unsigned long long	timeMicros;
+  	  int					pin;
+  	  int					value;
+  	  WriteKind				kind;
+  	} PinEvent;
+  	
+  	// Result of Run(): how many loop() calls, and what they cost on the host.
+  	typedef struct {
+  	  unsigned long			ticks;
+  	  unsigned long long	simMicros;
+  	  double				hostNanosTotal;
+  	  double				hostNanosMax;
+  	} RunStats;
+  	
+  	typedef void (*LoopFunction)();
+  	
+  public:
+  	// Back to power-on: time zero, all pins inputs, no recording, no scripted inputs, nothing
+  	// on the I2C bus.
+  	static void 			Reset();
+  	
+  	// Virtual clock.
+  	static unsigned long long	Now();
+  	static void				AdvanceMicros(unsigned long long us);
+  	static void				AdvanceMillis(unsigned long long ms);
+  	
+  	// Output pins.
+  	static int				GetPinMode(int pin);
+  	static int				GetPinValue(int pin);
+  	static unsigned long	GetWriteCount(int pin);
+  	static void				SetRecording(bool enabled);
+  	static void				ClearEvents();
+  	static const std::vector<PinEvent> &	GetEvents();
+  	static std::vector<PinEvent>			GetTrace(int pin);
+  	
+  	// Input pins: set now, or scripted for a future time (applied as the clock passes it).
+  	static void				SetDigitalInput(int pin, int level);
+  	static void				SetAnalogInput(int pin, int value);
+  	static void				ScheduleDigitalInput(unsigned long long atMillis, int pin, int level);
+  	static void				ScheduleAnalogInput(unsigned long long atMillis, int pin, int value);
+  	
+  	// I2C bus, behind the host Wire.h. An MCP23017 at the address, its GPA0-GPB7 wired to
+  	// firstPin to firstPin + 15 (set inputs and read outputs there), and INT on intPin. Only
+  	// IOCON.BANK = 0 is modelled, with INTA and INTB taken as mirrored.
+  	static void				AttachMcp23017(uint8_t address, int firstPin, int intPin = -1);
+  	// Transactions (counted at each stop) and the time they kept the bus, since Reset().
+  	static unsigned long		GetI2CTransactions();
+  	static unsigned long long	GetI2CMicros();
+  	
+  	// WS2812 strips: a model on the pin decodes the pulses sent to it, checking each against
+  	// the datasheet's timing, and latches a frame once the line has been low for 50us.
+  	static void				AttachWs2812(int pin, int pixelCount);
+  	// 0xRRGGBB, as the last latched frame left the pixel.
+  	static uint32_t			GetWs2812Pixel(int pin, int pixel);
+  	static unsigned long	GetWs2812Frames(int pin);
+  	static unsigned long	GetWs2812TimingErrors(int pin);
+  	
+  	// Serial port.
+  	static void				SetSerialEcho(bool echo);
+  	static std::string &	GetSerialOutput();
+  	static void				QueueSerialInput(const char *text);
+  	
+  	// Calls loopFn every tickMicros of virtual time, for durationMillis, timing each call on the host.
+  	static RunStats			Run(LoopFunction loopFn, unsigned long long durationMillis, unsigned long tickMicros);
+  	
+  	// Used by the Arduino.h functions, and directly for virtual pins, past the core's uint8_t.
+  	static void				WritePin(int pin, int value, WriteKind kind);
+  	static int				ReadDigital(int pin);
+  	static int				ReadAnalog(int pin);
+  	static void				SetPinMode(int pin, int mode);
+  	
+  	// Used by SeaRobPixels: one bit on a timed line, high then low, too short for WritePin().
+  	static void				Pulse(int pin, unsigned long highPicos, unsigned long lowPicos);
+  	
+  	// Used by Wire.h: false, or fewer bytes than asked for, when nothing answers.
+  	static bool				I2CWrite(uint8_t address, const uint8_t *data, int length, uint32_t clock, bool stop);
+  	static int				I2CRead(uint8_t address, uint8_t *data, int length, uint32_t clock, bool stop);
+};
+
+#endif // __searob_sim_h__
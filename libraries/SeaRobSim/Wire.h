@@ -0,0 +1,43 @@
+#ifndef __searob_sim_wire_h__
+#define __searob_sim_wire_h__
+
+#include "Arduino.h"
+
+// The AVR Wire library's buffer; a longer write fails here as it would on the board.
+#define BUFFER_LENGTH 32
+
+/*
+ * The Wire library, on the simulated I2C bus: transactions go to the device models attached
+ * to SeaRobSim, and move the virtual clock on by the time they would take on the wire.
+ */
+class TwoWire {
+  public:
+  					TwoWire() : _clock(100000L), _address(0), _txLength(0), _rxLength(0), _rxIndex(0), _sending(false) {}
+
+  		void		begin() {}
+  		void		setClock(uint32_t clock) { _clock = clock; }
+
+  		void		beginTransmission(uint8_t address);
+  		size_t		write(uint8_t data);
+  		size_t		write(const uint8_t *data, size_t quantity);
+  		// 0 when the device acknowledged, 2 when nothing answered at the address.
+  		uint8_t		endTransmission(uint8_t sendStop = true);
+
+  		uint8_t		requestFrom(uint8_t address, uint8_t quantity, uint8_t sendStop = true);
+  		int			available() { return _rxLength - _rxIndex; }
+  		int			read() { return (_rxIndex < _rxLength) ? _rxBuffer[_rxIndex++] : -1; }
+
+  private:
+  		uint32_t	_clock;
+  		uint8_t		_address;
+  		uint8_t		_txBuffer[BUFFER_LENGTH];
+  		uint8_t		_txLength;
+  		uint8_t		_rxBuffer[BUFFER_LENGTH];
+  		uint8_t		_rxLength;
+  		uint8_t		_rxIndex;
+  		bool		_sending;
+};
+
+extern TwoWire Wire;
+
+#endif // __searob_sim_wire_h__
@@ -0,0 +1,87 @@
+/*
+ * Runs a SeaRobSpringButtonLightList and a fading light for a few simulated hours, pressing the
+ * mode selector on a script, then reports the host cost per loop() and checks the blink timing
+ * of the synchronized blink mode against its configured on/off durations.
+ */
+#include "Arduino.h"
+#include "SeaRobSim.h"
+#include "SeaRobArena.h"
+#include "SeaRobLight.h"
+#include "SeaRobOutput.h"
+#include "SeaRobScheduler.h"
+#include "SeaRobSpringButtonLightList.h"
+
+#define NUM_LIGHTS 			5
+#define PIN_SELECTOR 		35
+#define PIN_FADE_LIGHT 		5
+#define SIM_HOURS 			4
+#define TICK_MICROS 		1000
+
+SeaRobSpringButtonLightList *	lightList = NULL;
+SeaRobLight *					fadeLight = NULL;
+
+/*
+ */
+void loop() {
+  SeaRobScheduler::Service(millis());
+  SeaRobOutput::Commit();
+}
+
+/*
+ * Presses (pulls low) the selector button at the given time, releasing it 100ms later.
+ */
+void pressSelector(unsigned long long atMillis) {
+  SeaRobSim::ScheduleDigitalInput(atMillis, PIN_SELECTOR, LOW);
+  SeaRobSim::ScheduleDigitalInput(atMillis + 100, PIN_SELECTOR, HIGH);
+}
+
+/*
+ */
+int main() {
+  SeaRobSim::Reset();
+  
+  int buttonPins[NUM_LIGHTS] = { 30, 31, 32, 33, 34 };
+  int lightPins[NUM_LIGHTS] = { 40, 41, 42, 43, 44 };
+  lightList = new SeaRobSpringButtonLightList(F("sim lights"), NUM_LIGHTS, buttonPins, lightPins, PIN_SELECTOR);
+  
+  fadeLight = new SeaRobLight(PIN_FADE_LIGHT, true);
+  fadeLight->UpdateBlinkConfig(0, 0, 1000, 5000, false, 5000, 5000);
+  fadeLight->UpdateState(SeaRobLight::LightState::UniformBlink);
+  SeaRobArena::Freeze();
+  
+  // Off -> ConstantOn -> SyncBlinkShort, then leave it there.
+  pressSelector(1000);
+  pressSelector(2000);
+  
+  SeaRobSim::SetRecording(true);
+  SeaRobSim::RunStats stats = SeaRobSim::Run(loop, SIM_HOURS * 3600ULL * 1000ULL, TICK_MICROS);
+  
+  printf("simulated %llu s in %lu ticks; host cost per tick: mean %.0f ns, max %.0f ns\n", 
+    stats.simMicros / 1000000ULL, stats.ticks, stats.hostNanosTotal / stats.ticks, stats.hostNanosMax);
+  
+  // SyncBlinkShort: 500ms on, 1000ms off, on every light.
+  int mismatches = 0;
+  int edges = 0;
+  for (int i = 0 ; i < NUM_LIGHTS ; i++) {
+    std::vector<SeaRobSim::PinEvent> trace = SeaRobSim::GetTrace(lightPins[i]);
+    for (size_t e = 1 ; e < trace.size() ; e++) {
+      if (trace[e - 1].timeMicros < 3000000ULL) {
+        continue; // still in the scripted mode changes
+      }
+      unsigned long long expected = trace[e - 1].value ? 500000ULL : 1000000ULL;
+      unsigned long long actual = trace[e].timeMicros - trace[e - 1].timeMicros;
+      long long error = (long long) actual - (long long) expected;
+      if ((error < -TICK_MICROS) || (error > TICK_MICROS)) {
+        mismatches++;
+      }
+      edges++;
+    }
+  }
+  printf("sync blink: %d edges, %d off by more than one tick\n", edges, mismatches);
+  
+  std::vector<SeaRobSim::PinEvent> fade = SeaRobSim::GetTrace(PIN_FADE_LIGHT);
+  printf("fade light: %lu level changes, %lu analogWrite calls\n", 
+    (unsigned long) fade.size(), SeaRobSim::GetWriteCount(PIN_FADE_LIGHT));
+  
+  return (mismatches == 0) ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+/*
+ * Drives the ssd1306 driver into a recording transport and checks the bytes that would go out on
+ * the bus: after the first full frame a small change is one column block, byte for byte, an edit
+ * that leaves a checksum unchanged is still sent, drawing during a flush does not leak into the
+ * frame being sent, and redrawing the same content sends nothing.
+ */
+#include "Arduino.h"
+#include "SeaRobSim.h"
+#include "Adafruit_ssd1306syp.h"
+
+#define LOG_CAPACITY 		4096
+
+ssd1306syp_RecordingTransport	recording(LOG_CAPACITY);
+Adafruit_ssd1306syp				display(&recording);
+int								failures = 0;
+
+/*
+ * Appends one recorded transaction (length, control, payload) to log.
+ */
+unsigned int appendTransaction(unsigned char *log, unsigned int size, unsigned char control, const unsigned char *buf, unsigned int len) {
+  log[size++] = (len + 1) & 0xff;
+  log[size++] = (len + 1) >> 8;
+  log[size++] = control;
+  memcpy(log + size, buf, len);
+  return size + len;
+}
+
+/*
+ * The two transactions that send block of row: the column window, then the 16 data bytes.
+ */
+unsigned int appendBlock(unsigned char *log, unsigned int size, unsigned char row, unsigned char block, const unsigned char *data) {
+  unsigned char col = block * SSD1306_BLOCK_WIDTH;
+  unsigned char cmds[3] = { (unsigned char) (0xb0 + row), (unsigned char) (col & 0x0f), (unsigned char) (0x10 | (col >> 4)) };
+  size = appendTransaction(log, size, SSD1306_CONTROL_CMD, cmds, 3);
+  return appendTransaction(log, size, SSD1306_CONTROL_DATA, data, SSD1306_BLOCK_WIDTH);
+}
+
+/*
+ */
+void expectLog(const char *label, const unsigned char *expected, unsigned int size) {
+  bool match = !recording.overflowed() && (recording.size() == size) && (memcmp(recording.data(), expected, size) == 0);
+  printf("%s: %u transactions, %u bytes%s\n", label, recording.transactionCount(), recording.size(), match ? "" : " - MISMATCH");
+  if (!match) {
+    failures++;
+  }
+  recording.reset();
+}
+
+/*
+ */
+int main() {
+  SeaRobSim::Reset();
+  
+  unsigned char expected[64];
+  unsigned char block[SSD1306_BLOCK_WIDTH];
+  unsigned int size;
+  
+  display.initialize();
+  recording.reset();
+  
+  // The first update sends the whole screen, a row window at a time.
+  display.drawPixel(40, 20, WHITE);
+  display.update();
+  bool full = (recording.transactionCount() == 2 * SSD1306_MAXROW) && (recording.payloadCount() == SSD1306_MAXROW * (3 + SSD1306_WIDTH));
+  printf("full frame: %u transactions, %lu payload bytes%s\n", recording.transactionCount(), recording.payloadCount(), full ? "" : " - MISMATCH");
+  if (!full) {
+    failures++;
+  }
+  recording.reset();
+  
+  // One more pixel in the same block: only that block, row 2 (y 16-23), columns 32-47.
+  display.drawPixel(41, 21, WHITE);
+  display.update();
+  memset(block, 0, sizeof(block));
+  block[8] = 1 << 4;
+  block[9] = 1 << 5;
+  size = appendBlock(expected, 0, 2, 2, block);
+  expectLog("single pixel", expected, size);
+  
+  // +1/-2/+1 across three adjacent bytes: the sums of a Fletcher checksum do not move.
+  display.drawPixel(65, 41, WHITE);
+  display.update();
+  recording.reset();
+  display.drawPixel(65, 41, BLACK);
+  display.drawPixel(64, 40, WHITE);
+  display.drawPixel(66, 40, WHITE);
+  display.update();
+  memset(block, 0, sizeof(block));
+  block[0] = 0x01;
+  block[2] = 0x01;
+  size = appendBlock(expected, 0, 5, 4, block);
+  expectLog("checksum collision", expected, size);
+  
+  // Drawing while a frame is on its way goes out with the next frame, not this one.
+  display.drawPixel(100, 0, WHITE);
+  display.beginUpdate();
+  display.drawPixel(101, 0, WHITE);
+  display.continueUpdate(0, 0);
+  memset(block, 0, sizeof(block));
+  block[4] = 0x01;
+  size = appendBlock(expected, 0, 0, 6, block);
+  expectLog("flush snapshot", expected, size);
+  display.update();
+  block[5] = 0x01;
+  size = appendBlock(expected, 0, 0, 6, block);
+  expectLog("next frame", expected, size);
+  
+  // Clearing and redrawing the same picture sends nothing.
+  display.clear();
+  display.drawPixel(40, 20, WHITE);
+  display.drawPixel(41, 21, WHITE);
+  display.drawPixel(64, 40, WHITE);
+  display.drawPixel(66, 40, WHITE);
+  display.drawPixel(100, 0, WHITE);
+  display.drawPixel(101, 0, WHITE);
+  display.update();
+  expectLog("same content", expected, 0);
+  
+  return (failures == 0) ? 0 : 1;
+}
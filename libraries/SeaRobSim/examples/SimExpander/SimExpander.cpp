@@ -0,0 +1,113 @@
+/*
+ * Runs a light and a button on an MCP23017 behind the simulated I2C bus and checks what each
+ * costs on the wire: one transaction for an output commit, none for scans while INT says
+ * nothing changed, and one read per sample for an input change until it is debounced.
+ */
+#include "Arduino.h"
+#include "SeaRobSim.h"
+#include "SeaRobExpander.h"
+#include "SeaRobInput.h"
+#include "SeaRobLight.h"
+#include "SeaRobOutput.h"
+#include "SeaRobScheduler.h"
+
+#define CHIP 				0
+#define PIN_INT 			2
+#define SIM_FIRST_PIN 		100 // GPA0 on the simulated board; GPB0 is 8 further
+#define PIN_LIGHT 			(EXPANDER_PIN_BASE + 16 * CHIP + 0) // GPA0
+#define PIN_BUTTON 			(EXPANDER_PIN_BASE + 16 * CHIP + 8) // GPB0
+#define TICK_MICROS 		1000
+
+// Nine bits a byte, the address included, plus start and stop, at EXPANDER_I2C_CLOCK.
+#define BUS_NANOS(bytes) 	((9ULL * ((bytes) + 1) + 2ULL) * 1000000000ULL / EXPANDER_I2C_CLOCK)
+// OLATA and both latches.
+#define WRITE_NANOS 		BUS_NANOS(3)
+// The GPIOA pointer, then both GPIO registers after a repeated start.
+#define READ_NANOS 			(BUS_NANOS(1) + BUS_NANOS(2))
+
+int				failures = 0;
+int				buttonChanges = 0;
+int				buttonLevel = HIGH;
+unsigned long	buttonTime = 0;
+
+/*
+ */
+void loop() {
+  SeaRobScheduler::Service(millis());
+  SeaRobOutput::Commit();
+}
+
+/*
+ */
+void onButton(void *, int level, unsigned long edgeTime) {
+  buttonChanges++;
+  buttonLevel = level;
+  buttonTime = edgeTime;
+}
+
+/*
+ * The bus counters are in whole microseconds of a nanosecond total, so a difference may be one
+ * off the exact figure.
+ */
+void expectBus(const char *label, unsigned long transactions, unsigned long long micros,
+    unsigned long expectedTransactions, unsigned long long expectedNanos) {
+  long long error = (long long) micros - (long long) (expectedNanos / 1000ULL);
+  bool match = (transactions == expectedTransactions) && (error >= -1) && (error <= 1);
+  printf("%s: %lu transactions, %llu us on the bus%s\n", label, transactions, micros, match ? "" : " - MISMATCH");
+  if (!match) {
+    failures++;
+  }
+}
+
+/*
+ */
+int main() {
+  SeaRobSim::Reset();
+  SeaRobSim::AttachMcp23017(EXPANDER_ADDRESS + CHIP, SIM_FIRST_PIN, PIN_INT);
+  
+  SeaRobLight *light = new SeaRobLight(PIN_LIGHT, false);
+  SeaRobInput::PinMode(PIN_BUTTON, INPUT_PULLUP);
+  SeaRobInput::Attach(PIN_BUTTON, HIGH, onButton, NULL);
+  if (!SeaRobExpander::Begin(CHIP, PIN_INT)) {
+    printf("chip %d does not answer - MISMATCH\n", CHIP);
+    return 1;
+  }
+  
+  // Let the first commit and the first (stale) read go by.
+  SeaRobSim::Run(loop, 100, TICK_MICROS);
+  
+  // One output commit: both latches in one write, on the loop() after the light is switched.
+  unsigned long transactions = SeaRobSim::GetI2CTransactions();
+  unsigned long long micros = SeaRobSim::GetI2CMicros();
+  light->UpdateState(SeaRobLight::LightState::On);
+  SeaRobSim::Run(loop, 10, TICK_MICROS);
+  expectBus("output commit", SeaRobSim::GetI2CTransactions() - transactions, SeaRobSim::GetI2CMicros() - micros, 1, WRITE_NANOS);
+  if (SeaRobSim::GetPinValue(SIM_FIRST_PIN) != HIGH) {
+    printf("light pin is low - MISMATCH\n");
+    failures++;
+  }
+  
+  // A second of scans with INT deasserted: the chip is never read.
+  transactions = SeaRobSim::GetI2CTransactions();
+  micros = SeaRobSim::GetI2CMicros();
+  SeaRobSim::Run(loop, 1000, TICK_MICROS);
+  expectBus("idle scans", SeaRobSim::GetI2CTransactions() - transactions, SeaRobSim::GetI2CMicros() - micros, 0, 0);
+  
+  // A press: INT wakes the scan, and the chip is read on every sample while the vertical
+  // counters run, four in all, the last accepting the level. Then it is quiet again.
+  transactions = SeaRobSim::GetI2CTransactions();
+  micros = SeaRobSim::GetI2CMicros();
+  unsigned long pressed = millis();
+  SeaRobSim::SetDigitalInput(SIM_FIRST_PIN + 8, LOW);
+  SeaRobSim::Run(loop, 100, TICK_MICROS);
+  unsigned long reads = SeaRobSim::GetI2CTransactions() - transactions;
+  expectBus("input change", reads, SeaRobSim::GetI2CMicros() - micros, 4, 4 * READ_NANOS);
+  bool accepted = (buttonChanges == 1) && (buttonLevel == LOW);
+  printf("button: %d change(s), level %d, accepted after %lu ms%s\n", buttonChanges, buttonLevel, 
+    buttonTime - pressed, accepted ? "" : " - MISMATCH");
+  if (!accepted) {
+    failures++;
+  }
+  
+  return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+/*
+ * Drives two WS2812 segments, each on its own strip, through dimmable SeaRobLights at several
+ * levels, and checks what the strip models decode: the GRB bytes of every pixel, no timing
+ * errors, a frame only for the strip that changed, and 30us a pixel on the wire.
+ */
+#include "Arduino.h"
+#include "SeaRobSim.h"
+#include "SeaRobLight.h"
+#include "SeaRobOutput.h"
+#include "SeaRobPixels.h"
+#include "SeaRobScheduler.h"
+
+#define PIN_STRIP_A 		6
+#define PIN_STRIP_B 		7
+#define PIXELS_A 			16
+#define PIXELS_B 			PIXELS_MAX_STRIP_PIXELS
+#define NUM_LEVELS 			5
+
+// 24 bits a pixel.
+#define FRAME_MICROS(pixels) 	((pixels) * 24ULL * PIXELS_BIT_CYCLES * PIXELS_CYCLE_PICOS / 1000000ULL)
+
+typedef struct {
+  SeaRobLight *		light;
+  int				pin; // the strip's data pin
+  int				pixelCount; // of the strip
+  int				first; // the segment's pixels
+  int				count;
+  uint8_t			red;
+  uint8_t			green;
+  uint8_t			blue;
+} Segment;
+
+int			failures = 0;
+
+/*
+ * What the strip should show for segment at level: each channel scaled as SeaRobPixels::Set()
+ * does, the pixels outside the segment dark.
+ */
+bool checkStrip(const Segment *segment, int level) {
+  uint32_t scale = level + 1;
+  uint32_t lit = (((segment->red * scale) >> 8) << 16) | (((segment->green * scale) >> 8) << 8) | ((segment->blue * scale) >> 8);
+  for (int p = 0 ; p < segment->pixelCount ; p++) {
+    uint32_t expected = ((p >= segment->first) && (p < segment->first + segment->count)) ? lit : 0;
+    if (SeaRobSim::GetWs2812Pixel(segment->pin, p) != expected) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Sets one segment's light to level, commits, and checks that only its strip was sent, in the
+ * time its length takes, with the right bytes.
+ */
+void step(Segment *segment, Segment *other, int level) {
+  unsigned long framesBefore = SeaRobSim::GetWs2812Frames(segment->pin);
+  unsigned long otherFrames = SeaRobSim::GetWs2812Frames(other->pin);
+  
+  segment->light->UpdateDimLevel(level);
+  SeaRobScheduler::Service(millis());
+  unsigned long long start = SeaRobSim::Now();
+  SeaRobOutput::Commit();
+  unsigned long long sendMicros = SeaRobSim::Now() - start;
+  SeaRobSim::AdvanceMicros(PIXELS_LATCH_MICROS);
+  
+  bool match = checkStrip(segment, level) 
+    && (SeaRobSim::GetWs2812Frames(segment->pin) == framesBefore + 1)
+    && (SeaRobSim::GetWs2812Frames(other->pin) == otherFrames)
+    && (sendMicros == FRAME_MICROS(segment->pixelCount));
+  printf("pin %d level %3d: pixel %d = %06x, sent in %llu us%s\n", segment->pin, level, segment->first, 
+    SeaRobSim::GetWs2812Pixel(segment->pin, segment->first), sendMicros, match ? "" : " - MISMATCH");
+  if (!match) {
+    failures++;
+  }
+}
+
+/*
+ */
+int main() {
+  SeaRobSim::Reset();
+  SeaRobSim::AttachWs2812(PIN_STRIP_A, PIXELS_A);
+  SeaRobSim::AttachWs2812(PIN_STRIP_B, PIXELS_B);
+  
+  Segment a = { NULL, PIN_STRIP_A, PIXELS_A, 4, 8, 255, 120, 0 };
+  Segment b = { NULL, PIN_STRIP_B, PIXELS_B, 10, 20, 30, 64, 255 };
+  int stripA = SeaRobPixels::AddStrip(PIN_STRIP_A, PIXELS_A);
+  int stripB = SeaRobPixels::AddStrip(PIN_STRIP_B, PIXELS_B);
+  if (SeaRobPixels::AddStrip(8, PIXELS_MAX_STRIP_PIXELS + 1) != -1) {
+    printf("strip over %d pixels accepted - MISMATCH\n", PIXELS_MAX_STRIP_PIXELS);
+    failures++;
+  }
+  a.light = new SeaRobLight(SeaRobPixels::AddSegment(stripA, a.first, a.count, a.red, a.green, a.blue), true);
+  b.light = new SeaRobLight(SeaRobPixels::AddSegment(stripB, b.first, b.count, b.red, b.green, b.blue), true);
+  
+  // Both strips go out dark once, then the lights come on at full level.
+  SeaRobOutput::Commit();
+  SeaRobSim::AdvanceMicros(PIXELS_LATCH_MICROS);
+  a.light->UpdateState(SeaRobLight::LightState::On);
+  b.light->UpdateState(SeaRobLight::LightState::On);
+  SeaRobScheduler::Service(millis());
+  SeaRobOutput::Commit();
+  SeaRobSim::AdvanceMicros(PIXELS_LATCH_MICROS);
+  
+  // Each a change from the light's last level, 255 to start with.
+  int levelsA[NUM_LEVELS] = { 128, 37, 1, 0, 255 };
+  int levelsB[NUM_LEVELS] = { 0, 255, 37, 1, 128 };
+  for (int i = 0 ; i < NUM_LEVELS ; i++) {
+    step(&a, &b, levelsA[i]);
+    step(&b, &a, levelsB[i]);
+  }
+  
+  // The same level again sends nothing.
+  unsigned long frames = SeaRobSim::GetWs2812Frames(PIN_STRIP_A);
+  a.light->UpdateDimLevel(levelsA[NUM_LEVELS - 1]);
+  SeaRobScheduler::Service(millis());
+  SeaRobOutput::Commit();
+  SeaRobSim::AdvanceMicros(PIXELS_LATCH_MICROS);
+  bool quiet = (SeaRobSim::GetWs2812Frames(PIN_STRIP_A) == frames);
+  printf("pin %d level %3d again: %s\n", PIN_STRIP_A, levelsA[NUM_LEVELS - 1], quiet ? "not sent" : "sent - MISMATCH");
+  if (!quiet) {
+    failures++;
+  }
+  
+  unsigned long errors = SeaRobSim::GetWs2812TimingErrors(PIN_STRIP_A) + SeaRobSim::GetWs2812TimingErrors(PIN_STRIP_B);
+  printf("frames: %lu and %lu, %lu timing errors\n", SeaRobSim::GetWs2812Frames(PIN_STRIP_A), 
+    SeaRobSim::GetWs2812Frames(PIN_STRIP_B), errors);
+  if ((errors != 0) || (SeaRobSim::GetWs2812Frames(PIN_STRIP_A) != 2 + NUM_LEVELS) 
+      || (SeaRobSim::GetWs2812Frames(PIN_STRIP_B) != 2 + NUM_LEVELS)) {
+    failures++;
+  }
+  
+  return (failures == 0) ? 0 : 1;
+}
@@ -35,7 +35,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "glcdfont.c"
 #ifdef __AVR__
  #include <avr/pgmspace.h>
-#else
+#elif !defined(pgm_read_byte)
  #define pgm_read_byte(addr) (*(const unsigned char *)(addr))
 #endif
 
@@ -1,11 +1,24 @@
 #include "Adafruit_ssd1306syp.h"
 
 Adafruit_ssd1306syp::Adafruit_ssd1306syp(int sda, int scl):
-Adafruit_GFX(SSD1306_WIDTH,SSD1306_HEIGHT)
+Adafruit_GFX(SSD1306_WIDTH,SSD1306_HEIGHT),
+m_bitBang(sda,scl)
 {
-	m_sda = sda;
-	m_scl = scl;
+	init(&m_bitBang);
+}
+Adafruit_ssd1306syp::Adafruit_ssd1306syp(ssd1306syp_Transport* transport):
+Adafruit_GFX(SSD1306_WIDTH,SSD1306_HEIGHT),
+m_bitBang(-1,-1)
+{
+	init(transport);
+}
+void Adafruit_ssd1306syp::init(ssd1306syp_Transport* transport)
+{
+	m_pTransport = transport;
 	m_pFramebuffer = 0;
+	m_pSendbuffer = 0;
+	memset(m_dirty,0,sizeof(m_dirty));
+	invalidate();
 }
 Adafruit_ssd1306syp::~Adafruit_ssd1306syp()
 {
@@ -13,13 +26,15 @@ Adafruit_ssd1306syp::~Adafruit_ssd1306syp()
 	if(m_pFramebuffer){
 		free(m_pFramebuffer);
 	}
+	if(m_pSendbuffer){
+		free(m_pSendbuffer);
+	}
 }
 //initialized the ssd1306 in the setup function
 bool Adafruit_ssd1306syp::initialize()
 {
-	//setup the pin mode
-	pinMode(m_sda,OUTPUT);
-	pinMode(m_scl,OUTPUT);
+	//setup the bus
+	m_pTransport->begin();
 
 	//malloc the framebuffer.
 	m_pFramebuffer = (unsigned char*)malloc(SSD1306_FBSIZE);
@@ -27,86 +42,89 @@ bool Adafruit_ssd1306syp::initialize()
 		return false;
 	}
 	memset(m_pFramebuffer,0,SSD1306_FBSIZE);//clear it.
+	//the copy that is being sent while the next frame is drawn; without it, frames are sent straight from the framebuffer.
+	m_pSendbuffer = (unsigned char*)malloc(SSD1306_FBSIZE);
+	invalidate();//the screen ram holds garbage until the first update.
 
 	//write command to the screen registers.
-	writeCommand(SSD1306_CMD_DISPLAY_OFF);//display off
-	writeCommand(0x00);//Set Memory Addressing Mode
-	writeCommand(0x10);//00,Horizontal Addressing Mode;01,Vertical Addressing Mode;10,Page Addressing Mode (RESET);11,Invalid
-	writeCommand(0x40);//Set Page Start Address for Page Addressing Mode,0-7
-	writeCommand(0xB0);//Set COM Output Scan Direction
-	writeCommand(0x81);//---set low column address
-	writeCommand(0xCF);//---set high column address
-	writeCommand(0xA1);//--set start line address
-	writeCommand(0xA6);//--set contrast control register
-	writeCommand(0xA8);
-	writeCommand(0x3F);//--set segment re-map 0 to 127
-	writeCommand(0xC8);//--set normal display
-	writeCommand(0xD3);//--set multiplex ratio(1 to 64)
-	writeCommand(0x00);//
-	writeCommand(0xD5);//0xa4,Output follows RAM content;0xa5,Output ignores RAM content
-	writeCommand(0x80);//-set display offset
-	writeCommand(0xD9);//-not offset
-	writeCommand(0xF1);//--set display clock divide ratio/oscillator frequency
-	writeCommand(0xDA);//--set divide ratio
-	writeCommand(0x12);//--set pre-charge period
-	writeCommand(0xDB);//
-	writeCommand(0x40);//--set com pins hardware configuration
-	writeCommand(0x8D);//--set vcomh
-	writeCommand(0x14);//0x20,0.77xVcc
-	writeCommand(0xAF);//--set DC-DC enable
-	writeCommand(SSD1306_CMD_DISPLAY_ON);//--turn on oled panel 
+	static const unsigned char initCommands[] = {
+		SSD1306_CMD_DISPLAY_OFF,//display off
+		0x00,//Set Memory Addressing Mode
+		0x10,//00,Horizontal Addressing Mode;01,Vertical Addressing Mode;10,Page Addressing Mode (RESET);11,Invalid
+		0x40,//Set Page Start Address for Page Addressing Mode,0-7
+		0xB0,//Set COM Output Scan Direction
+		0x81,//---set low column address
+		0xCF,//---set high column address
+		0xA1,//--set start line address
+		0xA6,//--set contrast control register
+		0xA8,
+		0x3F,//--set segment re-map 0 to 127
+		0xC8,//--set normal display
+		0xD3,//--set multiplex ratio(1 to 64)
+		0x00,//
+		0xD5,//0xa4,Output follows RAM content;0xa5,Output ignores RAM content
+		0x80,//-set display offset
+		0xD9,//-not offset
+		0xF1,//--set display clock divide ratio/oscillator frequency
+		0xDA,//--set divide ratio
+		0x12,//--set pre-charge period
+		0xDB,//
+		0x40,//--set com pins hardware configuration
+		0x8D,//--set vcomh
+		0x14,//0x20,0.77xVcc
+		0xAF,//--set DC-DC enable
+		SSD1306_CMD_DISPLAY_ON,//--turn on oled panel 
+	};
+	writeCommands(initCommands,sizeof(initCommands));
 
 	delay(10);//wait for the screen loaded.
 	return true;
 }
 void Adafruit_ssd1306syp::clear(bool isUpdateHW)
 {
-	memset(m_pFramebuffer,0,SSD1306_FBSIZE);//clear the back buffer.
-	if(isUpdateHW) update();//update the hw immediately
-}
+	unsigned char row,block,n;
+	unsigned char* p;
+	if(m_pFramebuffer == 0) return;
 
-void Adafruit_ssd1306syp::writeCommand(unsigned char cmd)
-{
-	startIIC();
-	writeByte(0x78);  //Slave address,SA0=0
-	writeByte(0x00);	//write command
-	writeByte(cmd);
-	stopIIC();
-}
-void Adafruit_ssd1306syp::writeByte(unsigned char b)
-{
-	unsigned char i;
-	for(i=0;i<8;i++)
+	//clear the back buffer, one block at a time so blocks that are already blank stay clean.
+	p = m_pFramebuffer;
+	for(row=0;row<SSD1306_MAXROW;row++)
 	{
-		if((b << i) & 0x80){
-			digitalWrite(m_sda, HIGH);
-		}else{
-			digitalWrite(m_sda, LOW);
+		for(block=0;block<SSD1306_BLOCKS_PER_ROW;block++)
+		{
+			for(n=0;n<SSD1306_BLOCK_WIDTH;n++)
+			{
+				if(p[n]) break;
+			}
+			if(n<SSD1306_BLOCK_WIDTH)
+			{
+				memset(p,0,SSD1306_BLOCK_WIDTH);
+				m_dirty[row] |= (1<<block);
+			}
+			p += SSD1306_BLOCK_WIDTH;
 		}
-		digitalWrite(m_scl, HIGH);
-		digitalWrite(m_scl, LOW);
-		//    IIC_Byte<<=1;
 	}
-	digitalWrite(m_sda, HIGH);
-	digitalWrite(m_scl, HIGH);
-	
-	digitalWrite(m_scl, LOW);
+	if(isUpdateHW) update();//update the hw immediately
+}
+void Adafruit_ssd1306syp::invalidate()
+{
+	m_fullRefresh = true;
+	memset(m_sendMask,0,sizeof(m_sendMask));
+	m_flushing = false;
+	m_flushRow = 0;
+	m_flushCol = 0;
+	m_flushStart = 0;
+	m_lastFrameMicros = 0;
 }
-void Adafruit_ssd1306syp::startIIC()
+
+void Adafruit_ssd1306syp::writeCommand(unsigned char cmd)
 {
-	digitalWrite(m_scl, HIGH);
-	digitalWrite(m_sda, HIGH);
-	digitalWrite(m_sda, LOW);
-	digitalWrite(m_scl, LOW);
+	m_pTransport->write(SSD1306_CONTROL_CMD,&cmd,1);
 }
-void Adafruit_ssd1306syp::stopIIC()
+void Adafruit_ssd1306syp::writeCommands(const unsigned char* cmds, unsigned int len)
 {
-	digitalWrite(m_scl, LOW);
-	digitalWrite(m_sda, LOW);
-	digitalWrite(m_scl, HIGH);
-	digitalWrite(m_sda, HIGH);	
+	m_pTransport->write(SSD1306_CONTROL_CMD,cmds,len);
 }
-
 void Adafruit_ssd1306syp::drawPixel(int16_t x, int16_t y, uint16_t color)
 {
 	unsigned char row;
@@ -127,69 +145,156 @@ void Adafruit_ssd1306syp::drawPixel(int16_t x, int16_t y, uint16_t color)
 	val = 1<<offset;
 	if(color!=0)
 	{//white! set bit.
-		m_pFramebuffer[index] = preData | val;
+		val = preData | val;
 	}else
 	{//black! clear bit.
-		m_pFramebuffer[index] = preData & (~val);
+		val = preData & (~val);
 	}
 
+	//only a real change makes the block dirty.
+	if(val != preData)
+	{
+		m_pFramebuffer[index] = val;
+		m_dirty[row] |= (1<<(x/SSD1306_BLOCK_WIDTH));
+	}
 }
 
-void Adafruit_ssd1306syp::startDataSequence()
+void Adafruit_ssd1306syp::writeWindow(const unsigned char* pBuffer, unsigned char rowID, unsigned char col, unsigned char len)
 {
-	startIIC();
-	writeByte(0x78);
-	writeByte(0x40);	//write data
-	
+	unsigned char cmds[3];
+
+	//set the position, page addressing mode.
+	cmds[0] = 0xb0+rowID;				//page0-page7
+	cmds[1] = 0x00|(col&0x0f);			//low column start address
+	cmds[2] = 0x10|((col>>4)&0x0f);		//high column start address
+	writeCommands(cmds,3);
+
+	//start painting the buffer.
+	m_pTransport->write(SSD1306_CONTROL_DATA,pBuffer + rowID*SSD1306_WIDTH + col,len);
 }
 void Adafruit_ssd1306syp::update()
 {
-#if 1
-	unsigned int  i=0;
-	unsigned char m,n;
-	for(m=0;m<8;m++)
+	//finish whatever is still on its way, then send the current frame in one go.
+	continueUpdate(0,0);
+	beginUpdate();
+	continueUpdate(0,0);
+}
+bool Adafruit_ssd1306syp::beginUpdate()
+{
+	unsigned char m,b;
+	unsigned char check,send;
+	unsigned int offset;
+
+	if(m_pFramebuffer == 0 || m_flushing) return false;
+
+	for(m=0;m<SSD1306_MAXROW;m++)
 	{
-		writeCommand(0xb0+m);	//page0-page1
-		writeCommand(0x00);		//low column start address
-		writeCommand(0x10);		//high column start address
-		
-		startDataSequence();
-		for(n=0;n<128;n++)
+		//find the blocks in this row that really differ from what the screen shows.
+		check = m_fullRefresh ? 0xff : m_dirty[m];
+		m_dirty[m] = 0;
+		send = 0;
+		for(b=0;b<SSD1306_BLOCKS_PER_ROW;b++)
 		{
-			writeByte(m_pFramebuffer[i++]);
+			if((check & (1<<b)) == 0) continue;
+			offset = m*SSD1306_WIDTH + b*SSD1306_BLOCK_WIDTH;
+			if(m_pSendbuffer == 0)
+			{
+				//no copy of the screen to compare with; every touched block goes out.
+				send |= (1<<b);
+			}
+			else if(m_fullRefresh || memcmp(m_pSendbuffer+offset,m_pFramebuffer+offset,SSD1306_BLOCK_WIDTH) != 0)
+			{
+				//the send buffer holds what the screen shows, so the snapshot is also the compare copy,
+				//and drawing the next frame cannot tear this one.
+				memcpy(m_pSendbuffer+offset,m_pFramebuffer+offset,SSD1306_BLOCK_WIDTH);
+				send |= (1<<b);
+			}
 		}
-		stopIIC();
+		m_sendMask[m] = send;
 	}
-#else
-	updateRow(0,SSD1306_MAXROW);
-#endif
-}
+	m_fullRefresh = false;
 
-void Adafruit_ssd1306syp::updateRow(int rowID)
+	m_flushRow = 0;
+	m_flushCol = 0;
+	m_flushStart = micros();
+	m_flushing = true;
+	return true;
+}
+bool Adafruit_ssd1306syp::continueUpdate(unsigned int maxBytes, unsigned long maxMicros)
 {
-	unsigned char x;
-	unsigned int  index;
-	if(rowID>=0 && rowID<SSD1306_MAXROW && m_pFramebuffer)
-	{//this part is faster than else.
-		//set the position
-		startIIC();
-		writeByte(0x78);  //Slave address,SA0=0
-		writeByte(0x00);	//write command
+	unsigned char b,end,len,mask;
+	unsigned int sent = 0;
+	unsigned long start;
+	const unsigned char* pBuffer = m_pSendbuffer ? m_pSendbuffer : m_pFramebuffer;
+
+	if(!m_flushing) return true;
+
+	start = micros();
+	while(m_flushRow<SSD1306_MAXROW)
+	{
+		//find the block the next column belongs to, or the next block to send in this row.
+		mask = m_sendMask[m_flushRow];
+		b = m_flushCol/SSD1306_BLOCK_WIDTH;
+		while(b<SSD1306_BLOCKS_PER_ROW && (mask & (1<<b)) == 0)
+		{
+			b++;
+		}
+		if(b>=SSD1306_BLOCKS_PER_ROW)
+		{
+			m_flushRow++;
+			m_flushCol = 0;
+			continue;
+		}
+		if(m_flushCol < b*SSD1306_BLOCK_WIDTH)
+		{
+			m_flushCol = b*SSD1306_BLOCK_WIDTH;
+		}
+
+		//out of budget? always send something, so every call makes progress.
+		if(sent>0)
+		{
+			if(maxBytes && sent>=maxBytes) return false;
+			if(maxMicros && (micros()-start)>=maxMicros) return false;
+		}
 
-		writeByte(0xb0+rowID);
-		writeByte(((x&0xf0)>>4)|0x10);//|0x10
-		writeByte((x&0x0f)|0x01);//|0x01
+		//the window runs to the end of this group of neighbouring blocks.
+		end = b;
+		while(end<SSD1306_BLOCKS_PER_ROW && (mask & (1<<end)))
+		{
+			end++;
+		}
+		len = end*SSD1306_BLOCK_WIDTH - m_flushCol;
+		if(maxBytes && len>(maxBytes-sent))
+		{
+			len = maxBytes-sent;
+		}
+		if(maxMicros && len>SSD1306_BLOCK_WIDTH)
+		{
+			len = SSD1306_BLOCK_WIDTH;//small steps, so the time budget is checked often.
+		}
+		writeWindow(pBuffer,m_flushRow,m_flushCol,len);
+		sent += len;
+		m_flushCol += len;
+	}
 
-		stopIIC();
+	m_flushing = false;
+	m_lastFrameMicros = micros()-m_flushStart;
+	return true;
+}
 
-		//start painting the buffer.
-		startDataSequence();
-		for(x=0;x<SSD1306_WIDTH;x++)
+void Adafruit_ssd1306syp::updateRow(int rowID)
+{
+	const unsigned char* pBuffer = m_pFramebuffer;
+	if(rowID>=0 && rowID<SSD1306_MAXROW && m_pFramebuffer)
+	{
+		//the whole row goes out, so the copy of the screen takes all of it.
+		if(m_pSendbuffer)
 		{
-			index = rowID*SSD1306_WIDTH+x;
-	  		writeByte(m_pFramebuffer[index]);
+			memcpy(m_pSendbuffer+rowID*SSD1306_WIDTH,m_pFramebuffer+rowID*SSD1306_WIDTH,SSD1306_WIDTH);
+			pBuffer = m_pSendbuffer;
 		}
-		stopIIC();
+		m_dirty[rowID] = 0;
+		writeWindow(pBuffer,rowID,0,SSD1306_WIDTH);
 	}
 }
 void Adafruit_ssd1306syp::updateRow(int startID, int endID)
@@ -8,6 +8,7 @@
  #include "WProgram.h"
 #endif
 #include <Adafruit_GFX.h>
+#include "ssd1306syp_transport.h"
 
 using namespace std;
 
@@ -19,19 +20,35 @@ using namespace std;
 #define SSD1306_HEIGHT 64
 #define SSD1306_FBSIZE 1024 //128x8
 #define SSD1306_MAXROW 8
+//dirty tracking: each row (page) is split into column blocks of 16 bytes.
+#define SSD1306_BLOCK_WIDTH 16
+#define SSD1306_BLOCKS_PER_ROW 8 //128/16, one bit per block in a row's dirty mask
 //command macro
   #define SSD1306_CMD_DISPLAY_OFF 0xAE//--turn off the OLED
   #define SSD1306_CMD_DISPLAY_ON 0xAF//--turn on oled panel 
 
 class Adafruit_ssd1306syp : public Adafruit_GFX{
 public:
+	//bit-banged i2c on any two pins.
 	Adafruit_ssd1306syp(int sda,int scl);
+	//any bus; the transport must outlive the screen.
+	Adafruit_ssd1306syp(ssd1306syp_Transport* transport);
 	~Adafruit_ssd1306syp();
 	//initialized the ssd1306 in the setup function
 	virtual bool initialize();
 
-	//update the framebuffer to the screen.
+	//update the framebuffer to the screen; only sends the column blocks whose content changed.
 	virtual void update();
+	//non-blocking update: beginUpdate() snapshots the changed blocks of the framebuffer (false if a frame is
+	//still being sent), continueUpdate() sends at most maxBytes of data or for maxMicros (0=no limit) and
+	//returns true once the whole frame is on the screen.
+	bool beginUpdate();
+	bool continueUpdate(unsigned int maxBytes, unsigned long maxMicros);
+	bool isFrameComplete(){ return !m_flushing; }
+	//micros from beginUpdate() until the last frame was completely sent.
+	unsigned long lastFrameMicros(){ return m_lastFrameMicros; }
+	//forget what the screen holds, so the next update() sends the whole framebuffer.
+	void invalidate();
 	//totoally 8 rows on this screen in vertical direction.
 	virtual void updateRow(int rowIndex);
 	virtual void updateRow(int startRow, int endRow);
@@ -42,19 +59,30 @@ public:
 	//clear the screen
 	void clear(bool isUpdateHW=false);
 protected:
-	//write one byte to the screen.
-	void writeByte(unsigned char  b);
+	//shared by the constructors; the buffers come later, from initialize().
+	void init(ssd1306syp_Transport* transport);
+	//write commands to the screen, all in one transaction.
 	void writeCommand(unsigned char  cmd);
-
-	//atomic control function
-	void startIIC();//turn on the IIC
-	void stopIIC();//turn off the IIC.
-	void startDataSequence();
+	void writeCommands(const unsigned char* cmds, unsigned int len);
+	//send len bytes of one row, starting at column col.
+	void writeWindow(const unsigned char* pBuffer, unsigned char rowID, unsigned char col, unsigned char len);
 
 	//
 protected:
-	int m_sda;
-	int m_scl;
+	ssd1306syp_BitBangTransport m_bitBang;//the default bus, unused when a transport is given.
+	ssd1306syp_Transport* m_pTransport;
 	unsigned char* m_pFramebuffer;//the frame buffer for the adafruit gfx. size=64x8 bytes
+
+	unsigned char m_dirty[SSD1306_MAXROW];//per row, one bit per column block touched since the last update.
+	bool m_fullRefresh;//screen content unknown; next update sends everything.
+
+	//incremental flush state.
+	unsigned char* m_pSendbuffer;//what was last sent to the screen, same layout as the framebuffer; changed blocks are compared against it.
+	unsigned char m_sendMask[SSD1306_MAXROW];//per row, the blocks of the frame being sent.
+	bool m_flushing;
+	unsigned char m_flushRow;
+	unsigned char m_flushCol;//next column to send in m_flushRow.
+	unsigned long m_flushStart;
+	unsigned long m_lastFrameMicros;
 };
 #endif
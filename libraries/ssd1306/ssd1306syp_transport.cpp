@@ -0,0 +1,128 @@
+#include "ssd1306syp_transport.h"
+#include <Wire.h>
+
+ssd1306syp_BitBangTransport::ssd1306syp_BitBangTransport(int sda, int scl)
+{
+	m_sda = sda;
+	m_scl = scl;
+}
+void ssd1306syp_BitBangTransport::begin()
+{
+	//setup the pin mode
+	pinMode(m_sda,OUTPUT);
+	pinMode(m_scl,OUTPUT);
+}
+void ssd1306syp_BitBangTransport::write(unsigned char control, const unsigned char* buf, unsigned int len)
+{
+	unsigned int n;
+	startIIC();
+	writeByte(SSD1306_I2C_ADDRESS<<1);  //Slave address,SA0=0
+	writeByte(control);
+	for(n=0;n<len;n++)
+	{
+		writeByte(buf[n]);
+	}
+	stopIIC();
+}
+void ssd1306syp_BitBangTransport::writeByte(unsigned char b)
+{
+	unsigned char i;
+	for(i=0;i<8;i++)
+	{
+		if((b << i) & 0x80){
+			digitalWrite(m_sda, HIGH);
+		}else{
+			digitalWrite(m_sda, LOW);
+		}
+		digitalWrite(m_scl, HIGH);
+		digitalWrite(m_scl, LOW);
+		//    IIC_Byte<<=1;
+	}
+	digitalWrite(m_sda, HIGH);
+	digitalWrite(m_scl, HIGH);
+	
+	digitalWrite(m_scl, LOW);
+}
+void ssd1306syp_BitBangTransport::startIIC()
+{
+	digitalWrite(m_scl, HIGH);
+	digitalWrite(m_sda, HIGH);
+	digitalWrite(m_sda, LOW);
+	digitalWrite(m_scl, LOW);
+}
+void ssd1306syp_BitBangTransport::stopIIC()
+{
+	digitalWrite(m_scl, LOW);
+	digitalWrite(m_sda, LOW);
+	digitalWrite(m_scl, HIGH);
+	digitalWrite(m_sda, HIGH);	
+}
+
+ssd1306syp_TwiTransport::ssd1306syp_TwiTransport(long clock)
+{
+	m_clock = clock;
+}
+void ssd1306syp_TwiTransport::begin()
+{
+	Wire.begin();
+	Wire.setClock(m_clock);
+}
+void ssd1306syp_TwiTransport::write(unsigned char control, const unsigned char* buf, unsigned int len)
+{
+	unsigned int n;
+	//the Wire buffer holds one burst; the column pointer auto increments, so long data spans several.
+	do
+	{
+		n = (len > SSD1306_TWI_BURST-1) ? (SSD1306_TWI_BURST-1) : len;
+		Wire.beginTransmission(SSD1306_I2C_ADDRESS);
+		Wire.write(control);
+		Wire.write(buf,n);
+		Wire.endTransmission();
+		buf += n;
+		len -= n;
+	}while(len > 0);
+}
+
+ssd1306syp_RecordingTransport::ssd1306syp_RecordingTransport(unsigned int capacity)
+{
+	m_pLog = (unsigned char*)malloc(capacity);
+	m_capacity = m_pLog ? capacity : 0;
+	reset();
+}
+ssd1306syp_RecordingTransport::~ssd1306syp_RecordingTransport()
+{
+	if(m_pLog){
+		free(m_pLog);
+	}
+}
+void ssd1306syp_RecordingTransport::begin()
+{
+}
+void ssd1306syp_RecordingTransport::reset()
+{
+	m_size = 0;
+	m_transactions = 0;
+	m_payload = 0;
+	m_overflow = false;
+}
+void ssd1306syp_RecordingTransport::append(unsigned char b)
+{
+	if(m_size < m_capacity){
+		m_pLog[m_size++] = b;
+	}else{
+		m_overflow = true;
+	}
+}
+void ssd1306syp_RecordingTransport::write(unsigned char control, const unsigned char* buf, unsigned int len)
+{
+	unsigned int n;
+	append((len+1)&0xff);
+	append((len+1)>>8);
+	append(control);
+	for(n=0;n<len;n++)
+	{
+		append(buf[n]);
+	}
+	m_transactions++;
+	m_payload += len;
+}
@@ -0,0 +1,80 @@
+#ifndef _IIC_SSD1306SYP_TRANSPORT_H_
+#define _IIC_SSD1306SYP_TRANSPORT_H_
+
+#if ARDUINO >= 100
+ #include "Arduino.h"
+#else
+ #include "WProgram.h"
+#endif
+
+//7 bit slave address of the screen, SA0=0 (0x78 on the wire).
+#define SSD1306_I2C_ADDRESS 0x3C
+//control bytes that start every transaction.
+#define SSD1306_CONTROL_CMD 0x00
+#define SSD1306_CONTROL_DATA 0x40
+//hardware twi: fast mode clock, and the Wire buffer size (control byte included).
+#define SSD1306_TWI_CLOCK 400000L
+#define SSD1306_TWI_BURST 32
+
+//the bus the screen hangs off; one write() is one i2c transaction.
+class ssd1306syp_Transport{
+public:
+	virtual ~ssd1306syp_Transport(){}
+	//setup the bus, called from initialize().
+	virtual void begin() = 0;
+	//send the control byte followed by len bytes of buf.
+	virtual void write(unsigned char control, const unsigned char* buf, unsigned int len) = 0;
+};
+
+//software i2c on any two pins, toggled with digitalWrite.
+class ssd1306syp_BitBangTransport : public ssd1306syp_Transport{
+public:
+	ssd1306syp_BitBangTransport(int sda,int scl);
+	virtual void begin();
+	virtual void write(unsigned char control, const unsigned char* buf, unsigned int len);
+protected:
+	//atomic control function
+	void startIIC();//turn on the IIC
+	void stopIIC();//turn off the IIC.
+	void writeByte(unsigned char b);
+protected:
+	int m_sda;
+	int m_scl;
+};
+
+//the TWI peripheral through the Wire library (pins 20/21 on the mega), sent in bulk bursts.
+class ssd1306syp_TwiTransport : public ssd1306syp_Transport{
+public:
+	ssd1306syp_TwiTransport(long clock=SSD1306_TWI_CLOCK);
+	virtual void begin();
+	virtual void write(unsigned char control, const unsigned char* buf, unsigned int len);
+protected:
+	long m_clock;
+};
+
+//records every transaction instead of sending it, for checking the exact bus output off the board.
+//each transaction is stored as: length (2 bytes, low first, control byte included), control, payload.
+class ssd1306syp_RecordingTransport : public ssd1306syp_Transport{
+public:
+	ssd1306syp_RecordingTransport(unsigned int capacity);
+	~ssd1306syp_RecordingTransport();
+	virtual void begin();
+	virtual void write(unsigned char control, const unsigned char* buf, unsigned int len);
+
+	void reset();
+	const unsigned char* data(){ return m_pLog; }
+	unsigned int size(){ return m_size; }
+	unsigned int transactionCount(){ return m_transactions; }
+	unsigned long payloadCount(){ return m_payload; }//data+command bytes, control bytes excluded
+	bool overflowed(){ return m_overflow; }
+protected:
+	void append(unsigned char b);
+protected:
+	unsigned char* m_pLog;
+	unsigned int m_capacity;
+	unsigned int m_size;
+	unsigned int m_transactions;
+	unsigned long m_payload;
+	bool m_overflow;
+};
+#endif